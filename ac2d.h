@@ -0,0 +1,289 @@
+// ac2d.h
+// AC_HASH en deux dimensions (mode AC2D) : le message est posé sur un tore
+// de W x H cellules et évolue selon une règle "outer-totalistic" de Moore :
+// la nouvelle valeur d'une cellule ne dépend que de son état et du nombre
+// de ses 8 voisines à 1 (notation B.../S... du Jeu de la vie).
+//
+// En 1D, une modification atteint au plus 2t+1 cellules après t générations ;
+// en 2D, (2t+1)^2 : il faut environ max(W, H) / 2 générations pour que chaque
+// bit de sortie dépende de tout le message, contre n en 1D.
+//
+// Représentation : une ligne = nw = W / 64 mots (même disposition que
+// PackedState : cellule x au bit x % 64 du mot x / 64), entourée de deux mots
+// de garde recopiés de l'autre extrémité (tore horizontal). Par mot, les 8
+// voisines sont obtenues par décalages des lignes du dessus, du dessous et de
+// la ligne elle-même, additionnées en tranches de bits (additionneurs
+// complets sur mots : 4 plans de bits du compte), puis la règle est lue
+// comme une table de 32 entrées index = centre * 16 + compte, évaluée par
+// l'arbre de multiplexeurs de rule2_words (ac_engine.h). Les grandes grilles
+// sont traitées par bandes de lignes, AC2D_TILE_STEPS générations par bande
+// (blocage temporel avec halo) pour rester dans le cache.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "ac_engine.h"
+#include "digest.h"
+
+// Règle : bits 0..8 = naissance pour 0..8 voisines, bits 16..24 = survie
+inline uint32_t ac2d_rule(uint32_t birthMask, uint32_t surviveMask) {
+    return (birthMask & 0x1FF) | ((surviveMask & 0x1FF) << 16);
+}
+
+// "B36/S23" -> ac2d_rule ; les caractères inconnus sont ignorés
+inline uint32_t ac2d_rule(const std::string& bs) {
+    uint32_t birth = 0, survive = 0, *cur = &birth;
+    for (char ch : bs) {
+        if (ch == 'B' || ch == 'b') cur = &birth;
+        else if (ch == 'S' || ch == 's') cur = &survive;
+        else if (ch >= '0' && ch <= '8') *cur |= 1u << (ch - '0');
+    }
+    return ac2d_rule(birth, survive);
+}
+
+// Règle par défaut, retenue sur 3000 règles tirées au hasard : effet
+// avalanche de 50 % (écart-type ~8 bits, celui d'une loi binomiale) et bits
+// de sortie équilibrés, de 8 à 1000 octets d'entrée. Les règles classiques
+// (B3/S23, B36/S23, Day & Night...) restent sous 45 %, et B1357/S02468 est
+// linéaire.
+const char* const AC2D_DEFAULT_RULE = "B2567/S0356";
+
+const size_t AC2D_MIN_ROWS = 16;
+const size_t AC2D_TILE_STEPS = 8;
+const size_t AC2D_TILE_BYTES = 128 * 1024;
+
+struct Grid2D {
+    size_t width = 0, height = 0; // cellules ; width multiple de 64
+    size_t nw = 0;                // mots de données par ligne
+    std::vector<uint64_t> buf;    // height lignes de nw + 2 mots
+
+    Grid2D() {}
+    Grid2D(size_t w, size_t h)
+        : width(w), height(h), nw(w / 64), buf(h * (w / 64 + 2), 0) {}
+
+    size_t stride() const { return nw + 2; }
+    uint64_t* row(size_t r) { return buf.data() + r * stride() + 1; }
+    const uint64_t* row(size_t r) const { return buf.data() + r * stride() + 1; }
+
+    int get(size_t x, size_t y) const { return (row(y)[x >> 6] >> (x & 63)) & 1; }
+    void set(size_t x, size_t y, int v) {
+        uint64_t bit = 1ULL << (x & 63);
+        if (v) row(y)[x >> 6] |= bit;
+        else   row(y)[x >> 6] &= ~bit;
+    }
+};
+
+// Géométrie pour `bits` cellules : lignes de 64·k cellules, k ≈ √bits / 64,
+// au moins AC2D_MIN_ROWS lignes
+inline Grid2D ac2d_grid_for(size_t bits) {
+    size_t words = std::max<size_t>(1, (size_t)std::ceil(std::sqrt((double)bits) / 64));
+    size_t width = 64 * words;
+    size_t height = std::max(AC2D_MIN_ROWS, (bits + width - 1) / width);
+    return Grid2D(width, height);
+}
+
+// Octets -> cellules, ligne par ligne, MSB en premier (comme pack_bytes) :
+// le bit i du message va en (i % W, i / W), XORé avec une constante
+// pseudo-aléatoire tirée de la longueur. Sans elle, un message nul laisserait
+// le tore vide (point fixe des règles sans B0), deux messages qui ne
+// diffèrent que par des zéros de fin auraient la même grille, et la symétrie
+// de translation du tore se verrait dans le hash.
+inline Grid2D ac2d_pack_bytes(const char* data, size_t len) {
+    Grid2D g = ac2d_grid_for(len * 8);
+    uint64_t seed = len;
+    for (size_t r = 0; r < g.height; ++r)
+        for (size_t j = 0; j < g.nw; ++j) g.row(r)[j] = splitmix64(seed);
+    size_t rowBytes = g.width / 8;
+    for (size_t k = 0; k < len; ++k) {
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(g.row(k / rowBytes));
+        bytes[k % rowBytes] ^= reverse_bits8((uint8_t)data[k]);
+    }
+    return g;
+}
+
+// Générations pour que chaque cellule voie tout le tore, plus une marge
+inline size_t ac2d_default_steps(const Grid2D& g) {
+    return std::max(g.width, g.height) / 2 + 4;
+}
+
+// Recopie des bords horizontaux dans les mots de garde
+inline void ac2d_wrap_row(uint64_t* row, size_t nw) {
+    row[-1] = row[nw - 1];
+    row[nw] = row[0];
+}
+
+// Additionneurs sur mots : a + b + c = s + 2·carry, bit à bit
+template <class W>
+AC_INLINE void full_add(const W& a, const W& b, const W& c, W& s, W& carry) {
+    W t = a ^ b;
+    s = t ^ c;
+    carry = (a & b) | (c & t);
+}
+
+// Une génération pour les mots [from, nw] d'une ligne (indices 1-based comme
+// step_scalar_loop : up/mid/down/out pointent sur le mot de garde gauche)
+template <class W>
+AC_INLINE void ac2d_step_word(const uint64_t* up, const uint64_t* mid, const uint64_t* down,
+                              uint64_t* out, size_t j, const RuleMasks2& rm) {
+    W u, m, d, t;
+    std::memcpy(&u, up + j, sizeof(W));
+    std::memcpy(&m, mid + j, sizeof(W));
+    std::memcpy(&d, down + j, sizeof(W));
+    W uw, ue, mw, me, dw, de;
+    std::memcpy(&t, up + j - 1, sizeof(W));   uw = (u << 1) | (t >> 63);
+    std::memcpy(&t, up + j + 1, sizeof(W));   ue = (u >> 1) | (t << 63);
+    std::memcpy(&t, mid + j - 1, sizeof(W));  mw = (m << 1) | (t >> 63);
+    std::memcpy(&t, mid + j + 1, sizeof(W));  me = (m >> 1) | (t << 63);
+    std::memcpy(&t, down + j - 1, sizeof(W)); dw = (d << 1) | (t >> 63);
+    std::memcpy(&t, down + j + 1, sizeof(W)); de = (d >> 1) | (t << 63);
+
+    // compte des 8 voisines en 4 plans de bits b3 b2 b1 b0
+    W s1, c1, s2, c2, s3, c3, b0, c4, t2, c5, b1, c6;
+    full_add(uw, u, ue, s1, c1);
+    full_add(mw, me, dw, s2, c2);
+    s3 = d ^ de; c3 = d & de;
+    full_add(s1, s2, s3, b0, c4);
+    full_add(c1, c2, c3, t2, c5);
+    b1 = t2 ^ c4; c6 = t2 & c4;
+    W b2 = c5 ^ c6, b3 = c5 & c6;
+
+    W next;
+    rule2_words(rm, m, b3, b2, b1, b0, next);
+    std::memcpy(out + j, &next, sizeof(W));
+}
+
+template <class V>
+AC_INLINE void ac2d_step_row_loop(const uint64_t* up, const uint64_t* mid, const uint64_t* down,
+                                  uint64_t* out, size_t nw, const RuleMasks2& rm) {
+    // pointeurs sur le mot de garde gauche : données en 1..nw
+    --up; --mid; --down; --out;
+    size_t j = 1;
+#if AC_ENGINE_X86
+    const size_t lanes = sizeof(V) / sizeof(uint64_t);
+    for (; j + lanes - 1 <= nw; j += lanes)
+        ac2d_step_word<V>(up, mid, down, out, j, rm);
+#endif
+    for (; j <= nw; ++j)
+        ac2d_step_word<uint64_t>(up, mid, down, out, j, rm);
+}
+
+typedef void (*Ac2dRowKernel)(const uint64_t*, const uint64_t*, const uint64_t*, uint64_t*,
+                              size_t, const RuleMasks2&);
+
+inline void ac2d_step_row(const uint64_t* up, const uint64_t* mid, const uint64_t* down,
+                          uint64_t* out, size_t nw, const RuleMasks2& rm) {
+    ac2d_step_row_loop<uint64_t>(up, mid, down, out, nw, rm);
+}
+
+#if AC_ENGINE_X86
+__attribute__((target("avx2")))
+inline void ac2d_step_row_avx2(const uint64_t* up, const uint64_t* mid, const uint64_t* down,
+                               uint64_t* out, size_t nw, const RuleMasks2& rm) {
+    ac2d_step_row_loop<u64x4>(up, mid, down, out, nw, rm);
+}
+#endif
+
+inline Ac2dRowKernel ac2d_row_kernel(size_t nw) {
+#if AC_ENGINE_X86
+    if (nw >= 4 && best_kernel_isa() != ISA_SCALAR) return ac2d_step_row_avx2;
+#endif
+    (void)nw;
+    return ac2d_step_row;
+}
+
+// `rows` lignes consécutives de src (indices modulo height), avec leurs gardes
+inline void ac2d_copy_rows(const Grid2D& src, long first, size_t rows, std::vector<uint64_t>& dst) {
+    size_t S = src.stride();
+    dst.resize(rows * S);
+    long H = (long)src.height;
+    for (size_t k = 0; k < rows; ++k) {
+        size_t r = (size_t)(((first + (long)k) % H + H) % H);
+        std::memcpy(dst.data() + k * S, src.row(r) - 1, S * sizeof(uint64_t));
+    }
+}
+
+// Fait évoluer le tore `steps` générations (en place)
+inline void evolve_2d(Grid2D& g, uint32_t rule, size_t steps) {
+    if (g.height == 0 || steps == 0) return;
+    RuleMasks2 rm(rule);
+    const size_t H = g.height, nw = g.nw, S = g.stride();
+    Ac2dRowKernel step = ac2d_row_kernel(nw);
+
+    // petites grilles : tout le tore tient dans le cache, une génération à la
+    // fois avec repliement vertical
+    if (g.buf.size() * sizeof(uint64_t) <= AC2D_TILE_BYTES) {
+        Grid2D next(g.width, H);
+        for (size_t s = 0; s < steps; ++s) {
+            for (size_t r = 0; r < H; ++r) ac2d_wrap_row(g.row(r), nw);
+            for (size_t r = 0; r < H; ++r)
+                step(g.row((r + H - 1) % H), g.row(r), g.row((r + 1) % H), next.row(r), nw, rm);
+            g.buf.swap(next.buf);
+        }
+        return;
+    }
+
+    // grandes grilles : bandes de `band` lignes plus un halo de T lignes de
+    // chaque côté ; T générations dans la bande (le halo se dégrade d'une
+    // ligne par génération), puis les lignes centrales exactes sont écrites
+    size_t band = std::max<size_t>(16, AC2D_TILE_BYTES / (2 * S * sizeof(uint64_t)));
+    Grid2D next(g.width, H);
+    std::vector<uint64_t> a, b;
+    for (size_t done = 0; done < steps;) {
+        size_t T = std::min(AC2D_TILE_STEPS, steps - done);
+        for (size_t first = 0; first < H; first += band) {
+            size_t rows = std::min(band, H - first);
+            size_t total = rows + 2 * T;
+            ac2d_copy_rows(g, (long)first - (long)T, total, a);
+            b.assign(a.size(), 0);
+            for (size_t s = 0; s < T; ++s) {
+                for (size_t k = s; k < total - s; ++k) ac2d_wrap_row(a.data() + k * S + 1, nw);
+                for (size_t k = s + 1; k + s + 1 < total; ++k)
+                    step(a.data() + (k - 1) * S + 1, a.data() + k * S + 1,
+                         a.data() + (k + 1) * S + 1, b.data() + k * S + 1, nw, rm);
+                a.swap(b);
+            }
+            for (size_t k = 0; k < rows; ++k)
+                std::memcpy(next.row(first + k), a.data() + (T + k) * S + 1, nw * sizeof(uint64_t));
+        }
+        g.buf.swap(next.buf);
+        done += T;
+    }
+}
+
+// 256 bits de sortie : le tore replié par XOR, bit i = XOR des cellules
+// j = i mod 256 (cellule j = (j % W, j / W)), bits lus comme packed_to_digest.
+// Deux cellules voisines sont égales dans ~55 % des cas (corrélation 0.11,
+// 0.04 à distance 2) : les lire telles quelles fait échouer les tests runs et
+// serial (partie6). Avec au moins AC2D_MIN_ROWS lignes, chaque bit combine au
+// moins 4 cellules éloignées de 4 lignes, et la corrélation entre bits de
+// sortie voisins tombe vers 0.11^4.
+inline Digest ac2d_to_digest(const Grid2D& g) {
+    uint64_t acc[DIGEST_WORDS] = {};
+    size_t j = 0;
+    for (size_t r = 0; r < g.height; ++r) {
+        const uint64_t* row = g.row(r);
+        for (size_t w = 0; w < g.nw; ++w, ++j) acc[j % DIGEST_WORDS] ^= row[w];
+    }
+    Digest d;
+    for (size_t k = 0; k < DIGEST_BYTES; ++k)
+        d[k] = reverse_bits8((uint8_t)(acc[k / 8] >> (8 * (k % 8))));
+    return d;
+}
+
+// steps = 0 : ac2d_default_steps (diffusion sur tout le tore)
+inline Digest ac2d_hash(const char* data, size_t len, uint32_t rule = ac2d_rule(AC2D_DEFAULT_RULE),
+                        size_t steps = 0) {
+    Grid2D g = ac2d_pack_bytes(data, len);
+    evolve_2d(g, rule, steps ? steps : ac2d_default_steps(g));
+    return ac2d_to_digest(g);
+}
+
+inline Digest ac2d_hash(const std::string& input, uint32_t rule = ac2d_rule(AC2D_DEFAULT_RULE),
+                        size_t steps = 0) {
+    return ac2d_hash(input.data(), input.size(), rule, steps);
+}
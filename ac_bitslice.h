@@ -0,0 +1,120 @@
+// ac_bitslice.h
+// Minage AC_HASH "bitslicé" : 64 nonces candidats évalués en même temps.
+//
+// Les candidats d'un même lot ne diffèrent que par leur nonce. On les
+// transpose en plans de bits : le mot plane[i] contient la cellule i des 64
+// messages (bit L = candidat L). Une génération s'écrit alors
+//     next[i] = règle(plane[i-1], plane[i], plane[i+1])
+// soit une seule expression booléenne (spécialisée par règle, voir RuleExpr)
+// par cellule et par génération pour les 64 candidats, sans aucun décalage.
+// Comme AcDifficultyProbe, seules les cellules [0, m + steps) qui donnent les
+// m premiers bits du hash (ceux que la cible impose à zéro) sont évoluées, et
+// les 64 candidats sont comparés en une passe (OU des plans de sortie).
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "ac_engine.h"
+#include "ac_incremental.h"
+
+typedef void (*PlaneKernel)(const uint64_t* src, uint64_t* dst, size_t count);
+
+// src/dst : plans de garde en 0 et count+1, plans de cellules en 1..count
+template <unsigned R>
+struct PlaneRuleKernel {
+    static void run(const uint64_t* src, uint64_t* dst, size_t count) {
+        FixedRule<R> rule;
+        for (size_t i = 1; i <= count; ++i)
+            rule(src[i-1], src[i], src[i+1], dst[i]);
+    }
+};
+
+inline PlaneKernel plane_kernel(uint32_t rule) {
+    static const PlaneKernel* table =
+        make_rule_kernel_table<PlaneRuleKernel>(std::make_index_sequence<256>());
+    return table[rule & 0xFF];
+}
+
+class AcBitslicedProbe {
+public:
+    static const int LANES = 64;
+
+    // zeroBits : nombre de bits de tête du hash qui doivent être nuls
+    AcBitslicedProbe(const std::string& prefix, uint32_t rule, size_t steps, size_t zeroBits,
+                     NonceEncoder encode = decimal_nonce)
+        : prefix_(prefix), steps_(steps), m_(zeroBits),
+          P_(prefix.size() * 8), kernel_(plane_kernel(rule)), encode_(encode) {
+        constant_ = m_ + steps_ <= P_;
+        if (constant_) constantResult_ = (test_batch(0, 1) & 1) != 0;
+    }
+
+    bool depends_on_nonce() const { return !constant_; }
+    bool unreachable() const { return constant_ && !constantResult_; }
+
+    // Résultat pour un nonce ; les nonces sont évalués par lots d'au plus 64
+    // consécutifs, mis en cache.
+    bool passes(int64_t nonce) {
+        if (constant_) return constantResult_;
+        if (nonce < batchFirst_ || nonce >= batchFirst_ + batchCount_) {
+            batchFirst_ = nonce;
+            batchMask_ = test_batch(batchFirst_, LANES);
+        }
+        return (batchMask_ >> (nonce - batchFirst_)) & 1;
+    }
+
+    // Bit L à 1 si le nonce first+L atteint la cible. Le lot s'arrête avant
+    // le premier nonce dont l'encodage change de longueur (passage de 99 à
+    // 100 par exemple) : tous les candidats ont la même taille de message.
+    uint64_t test_batch(int64_t first, int maxCount) {
+        char bytes[NONCE_MAX_BYTES];
+        size_t len = encode_(first, bytes);
+        size_t n = P_ + len * 8;
+        size_t cells = std::min(n, m_ + steps_);
+        cur_.assign(cells + 2, 0);
+        next_.assign(cells + 2, 0);
+
+        // transposition : cellules du préfixe communes à tous les candidats,
+        // puis les bits du nonce de chaque candidat dans sa ligne
+        for (size_t i = 0; i < std::min(P_, cells); ++i)
+            if (((uint8_t)prefix_[i / 8] >> (7 - i % 8)) & 1) cur_[1 + i] = ~0ULL;
+        int count = 0;
+        for (; count < maxCount; ++count) {
+            if (encode_(first + count, bytes) != len) break;
+            for (size_t k = 0; k < len; ++k)
+                for (size_t j = 0; j < 8; ++j) {
+                    size_t cell = P_ + 8 * k + j;
+                    if (cell < cells && (((uint8_t)bytes[k] >> (7 - j)) & 1))
+                        cur_[1 + cell] |= 1ULL << count;
+                }
+        }
+        batchCount_ = count;
+
+        for (size_t t = 0; t < steps_; ++t) {
+            kernel_(cur_.data(), next_.data(), cells);
+            cur_.swap(next_);
+        }
+
+        uint64_t fail = 0;
+        for (size_t i = 0; i < m_; ++i)
+            fail |= cur_[1 + i % n];
+        uint64_t lanes = count == LANES ? ~0ULL : (1ULL << count) - 1;
+        return ~fail & lanes;
+    }
+
+private:
+    std::string prefix_;
+    size_t steps_;
+    size_t m_;
+    size_t P_;
+    PlaneKernel kernel_;
+    NonceEncoder encode_;
+    bool constant_;
+    bool constantResult_ = false;
+    int64_t batchFirst_ = 0;
+    int batchCount_ = 0;
+    uint64_t batchMask_ = 0;
+    std::vector<uint64_t> cur_, next_;
+};
@@ -0,0 +1,853 @@
+// ac_engine.h
+// Moteur d'évolution partagé pour AC_HASH.
+//
+// L'état de l'automate est stocké "bit-packé" : 64 cellules par uint64_t,
+// la cellule i se trouve dans le mot i / 64, au bit i % 64 (bit de poids
+// faible = cellule la plus à gauche du mot). Une génération complète se
+// calcule avec des décalages et des opérations booléennes sur des mots
+// entiers, au lieu d'un appel à apply_rule par cellule.
+//
+// Les deux variantes de bord du dépôt sont supportées :
+//   - ZERO_BOUNDARY     : voisins hors de l'état = 0 (evolve des exercices)
+//   - PERIODIC_BOUNDARY : état circulaire (evolve_ca de partie7)
+// et les résultats sont identiques bit à bit aux versions de référence.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <bitset>
+#include <cstring>
+#include <utility>
+#include <memory>
+#include <mutex>
+#include "cpu_features.h"
+#include "digest.h"
+
+enum Boundary { ZERO_BOUNDARY, PERIODIC_BOUNDARY };
+
+// ===========================================================
+// ============ VERSION DE RÉFÉRENCE (1 cellule / int) =======
+// ===========================================================
+
+inline int apply_rule(uint32_t rule, int left, int center, int right) {
+    int index = left * 4 + center * 2 + right; // binaire -> index
+    return (rule >> index) & 1;
+}
+
+inline std::vector<int> evolve(const std::vector<int>& state, uint32_t rule) {
+    int n = state.size();
+    std::vector<int> next_state(n, 0);
+    for (int i = 0; i < n; i++) {
+        int left   = (i == 0) ? 0 : state[i-1];
+        int center = state[i];
+        int right  = (i == n-1) ? 0 : state[i+1];
+        next_state[i] = apply_rule(rule, left, center, right);
+    }
+    return next_state;
+}
+
+// Voisinage de rayon 2 (5 cellules) : la règle est une table de 32 bits,
+// index = l2*16 + l1*8 + c*4 + r1*2 + r2 (l2 = cellule i-2)
+inline int apply_rule_r2(uint32_t rule, int l2, int l1, int center, int r1, int r2) {
+    int index = l2 * 16 + l1 * 8 + center * 4 + r1 * 2 + r2;
+    return (rule >> index) & 1;
+}
+
+inline std::vector<int> evolve_r2(const std::vector<int>& state, uint32_t rule) {
+    int n = state.size();
+    std::vector<int> next_state(n, 0);
+    auto cell = [&](int i) { return (i < 0 || i >= n) ? 0 : state[i]; };
+    for (int i = 0; i < n; i++)
+        next_state[i] = apply_rule_r2(rule, cell(i-2), cell(i-1), state[i], cell(i+1), cell(i+2));
+    return next_state;
+}
+
+inline std::vector<int> text_to_bits(const std::string& input) {
+    std::vector<int> bits;
+    for (char c : input) {
+        std::bitset<8> b(c); // chaque caractère en ASCII -> 8 bits
+        for (int i = 7; i >= 0; --i)
+            bits.push_back(b[i]);
+    }
+    return bits;
+}
+
+// ===========================================================
+// ==================== ÉTAT BIT-PACKÉ =======================
+// ===========================================================
+
+// buf[0] et buf[nwords()+1] sont des mots de garde : ils portent les voisins
+// hors bornes (0 ou cellules recopiées de l'autre extrémité), ce qui évite
+// tout test de bord dans la boucle principale. Les bits au-delà de n dans le
+// dernier mot de données sont toujours maintenus à 0.
+struct PackedState {
+    size_t n;
+    std::vector<uint64_t> buf;
+
+    PackedState() : n(0), buf(2, 0) {}
+    explicit PackedState(size_t cells) : n(cells), buf(words_for(cells) + 2, 0) {}
+
+    static size_t words_for(size_t cells) { return (cells + 63) / 64; }
+
+    size_t nwords() const { return words_for(n); }
+    uint64_t* words() { return buf.data() + 1; }
+    const uint64_t* words() const { return buf.data() + 1; }
+
+    int get(size_t i) const { return (words()[i >> 6] >> (i & 63)) & 1; }
+    void set(size_t i, int v) {
+        uint64_t bit = 1ULL << (i & 63);
+        if (v) words()[i >> 6] |= bit;
+        else   words()[i >> 6] &= ~bit;
+    }
+
+    void mask_tail() {
+        if (n & 63) words()[nwords() - 1] &= (1ULL << (n & 63)) - 1;
+    }
+};
+
+inline uint8_t reverse_bits8(uint8_t b) {
+    b = (uint8_t)((b >> 4) | (b << 4));
+    b = (uint8_t)(((b & 0xCC) >> 2) | ((b & 0x33) << 2));
+    b = (uint8_t)(((b & 0xAA) >> 1) | ((b & 0x55) << 1));
+    return b;
+}
+
+inline uint64_t reverse_bits64(uint64_t x) {
+    x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    return __builtin_bswap64(x);
+}
+
+// Générateur splitmix64 : constantes d'initialisation (IV) reproductibles
+inline uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Octets -> cellules, 8 bits par octet MSB en premier (comme text_to_bits)
+inline PackedState pack_bytes(const char* data, size_t len) {
+    PackedState s(len * 8);
+    uint64_t* w = s.words();
+    for (size_t k = 0; k < len; ++k)
+        w[k >> 3] |= (uint64_t)reverse_bits8((uint8_t)data[k]) << ((k & 7) * 8);
+    return s;
+}
+
+inline PackedState pack_text(const std::string& input) {
+    return pack_bytes(input.data(), input.size());
+}
+
+template <class Cell>
+PackedState pack_cells(const std::vector<Cell>& cells) {
+    PackedState s(cells.size());
+    for (size_t i = 0; i < cells.size(); ++i)
+        if (cells[i]) s.words()[i >> 6] |= 1ULL << (i & 63);
+    return s;
+}
+
+template <class Cell>
+std::vector<Cell> unpack_cells(const PackedState& s) {
+    std::vector<Cell> cells(s.n);
+    for (size_t i = 0; i < s.n; ++i)
+        cells[i] = (Cell)s.get(i);
+    return cells;
+}
+
+// ===========================================================
+// ============ GÉNÉRATION SUIVANTE SUR DES MOTS =============
+// ===========================================================
+
+// masks[k] vaut ~0 si le bit k de la règle est à 1, 0 sinon
+struct RuleMasks {
+    uint64_t m[8];
+    explicit RuleMasks(uint32_t rule) {
+        for (int k = 0; k < 8; ++k)
+            m[k] = ((rule >> k) & 1) ? ~0ULL : 0ULL;
+    }
+};
+
+// Évalue la règle sur 64 cellules à la fois : l, c, r sont les mots des
+// voisins gauche, centre et droit (index = l*4 + c*2 + r). W est uint64_t
+// ou un vecteur de mots (noyaux SIMD plus bas) ; les vecteurs passent par
+// référence pour ne pas dépendre de l'ABI AVX hors des noyaux.
+template <class W>
+AC_INLINE void rule_words(const RuleMasks& rm, const W& l, const W& c, const W& r, W& out) {
+    const uint64_t* m = rm.m;
+    W nc = ~c, nr = ~r;
+    W a0 = nc & nr, a1 = nc & r, a2 = c & nr, a3 = c & r;
+    W lo = (a0 & m[0]) | (a1 & m[1]) | (a2 & m[2]) | (a3 & m[3]);
+    W hi = (a0 & m[4]) | (a1 & m[5]) | (a2 & m[6]) | (a3 & m[7]);
+    out = (l & hi) | (~l & lo);
+}
+
+inline uint64_t rule_word(const RuleMasks& rm, uint64_t l, uint64_t c, uint64_t r) {
+    uint64_t out;
+    rule_words(rm, l, c, r, out);
+    return out;
+}
+
+// ===========================================================
+// ======= RÈGLES SPÉCIALISÉES À LA COMPILATION (0..255) =====
+// ===========================================================
+
+// RuleExpr<TT, NV> : fonction booléenne de NV variables dont la table de
+// vérité est TT (v[0] = variable de poids fort). La table est découpée sur
+// la première variable (décomposition de Shannon) et chaque cas particulier
+// se réduit à une seule opération : cofacteurs égaux (variable inutile),
+// complémentaires (XOR), nuls ou pleins (AND / OR). Par exemple :
+//   rule 30  -> l ^ (c | r)      rule 90  -> l ^ r
+//   rule 150 -> l ^ (c ^ r)      rule 110 -> (c | r) ^ (l & (c & r))
+template <unsigned TT, int NV>
+struct RuleExpr {
+    static constexpr unsigned HALF = 1u << (NV - 1);
+    static constexpr unsigned MASK = (1u << HALF) - 1;
+    static constexpr unsigned LO = TT & MASK;           // v[0] = 0
+    static constexpr unsigned HI = (TT >> HALF) & MASK; // v[0] = 1
+
+    template <class W>
+    static AC_INLINE void eval(const W* v, W& out) {
+        typedef RuleExpr<LO, NV - 1> Lo;
+        typedef RuleExpr<HI, NV - 1> Hi;
+        if constexpr (HI == LO) {
+            Lo::eval(v + 1, out);
+        } else if constexpr (HI == (~LO & MASK)) {
+            Lo::eval(v + 1, out); out = v[0] ^ out;
+        } else if constexpr (LO == 0) {
+            Hi::eval(v + 1, out); out = v[0] & out;
+        } else if constexpr (HI == 0) {
+            Lo::eval(v + 1, out); out = ~v[0] & out;
+        } else if constexpr (HI == MASK) {
+            Lo::eval(v + 1, out); out = v[0] | out;
+        } else if constexpr (LO == MASK) {
+            Hi::eval(v + 1, out); out = ~v[0] | out;
+        } else {
+            W diff;
+            Lo::eval(v + 1, out);
+            RuleExpr<LO ^ HI, NV - 1>::eval(v + 1, diff);
+            out = out ^ (v[0] & diff);
+        }
+    }
+};
+
+template <unsigned TT>
+struct RuleExpr<TT, 0> {
+    template <class W>
+    static AC_INLINE void eval(const W*, W& out) {
+        W zero{};
+        out = (TT & 1) ? ~zero : zero;
+    }
+};
+
+// Politiques d'évaluation utilisées par les boucles de génération :
+// MaskRule lit la règle à l'exécution, FixedRule<R> est entièrement résolue
+// à la compilation.
+struct MaskRule {
+    const RuleMasks& rm;
+    template <class W>
+    AC_INLINE void operator()(const W& l, const W& c, const W& r, W& out) const {
+        rule_words(rm, l, c, r, out);
+    }
+};
+
+template <unsigned R>
+struct FixedRule {
+    template <class W>
+    AC_INLINE void operator()(const W& l, const W& c, const W& r, W& out) const {
+        const W v[3] = { l, c, r };
+        RuleExpr<R & 0xFF, 3>::eval(v, out);
+    }
+};
+
+// Remplit les mots de garde (et les bits n .. n+radius-1) selon le mode de
+// bord : `radius` cellules de chaque côté
+inline void prepare_boundary(PackedState& s, Boundary boundary, size_t radius = 1) {
+    uint64_t* b = s.buf.data();
+    b[0] = 0;
+    b[s.nwords() + 1] = 0;
+    if (boundary == PERIODIC_BOUNDARY && s.n > 0) {
+        for (size_t k = 1; k <= radius; ++k) {
+            b[0] |= (uint64_t)s.get((s.n - k % s.n) % s.n) << (64 - k);
+            size_t p = 64 + s.n + k - 1; // position absolue de la cellule n+k-1 dans buf
+            b[p >> 6] |= (uint64_t)s.get((k - 1) % s.n) << (p & 63);
+        }
+    }
+}
+
+// src et dst pointent sur buf (mots de garde compris), nw mots de données.
+// `from` permet aux noyaux SIMD de finir les derniers mots en scalaire.
+template <class Rule>
+AC_INLINE void step_scalar_loop(const uint64_t* src, uint64_t* dst, size_t nw,
+                                const Rule& rule, size_t from) {
+    for (size_t j = from; j <= nw; ++j) {
+        uint64_t c = src[j];
+        uint64_t l = (c << 1) | (src[j-1] >> 63);
+        uint64_t r = (c >> 1) | (src[j+1] << 63);
+        rule(l, c, r, dst[j]);
+    }
+}
+
+inline void step_words(const uint64_t* src, uint64_t* dst, size_t nw,
+                       const RuleMasks& rm, size_t from = 1) {
+    step_scalar_loop(src, dst, nw, MaskRule{rm}, from);
+}
+
+// ===========================================================
+// ============ NOYAUX SIMD (AVX2 / AVX-512) =================
+// ===========================================================
+
+// Un vecteur = 4 (AVX2) ou 8 (AVX-512) mots consécutifs, soit 256 ou 512
+// cellules par instruction. La retenue entre voisins traverse les lignes du
+// vecteur grâce à deux chargements non alignés décalés d'un mot (src+j-1 et
+// src+j+1) : chaque ligne reçoit ainsi le bit 63 du mot précédent et le bit 0
+// du mot suivant, mots de garde compris, quel que soit le mode de bord.
+#if AC_ENGINE_X86
+typedef uint64_t u64x4 __attribute__((vector_size(32)));
+typedef uint64_t u64x8 __attribute__((vector_size(64)));
+
+template <class V, class Rule>
+AC_INLINE void step_vector(const uint64_t* src, uint64_t* dst, size_t j, const Rule& rule) {
+    V c, p, n;
+    std::memcpy(&c, src + j, sizeof(V));
+    std::memcpy(&p, src + j - 1, sizeof(V));
+    std::memcpy(&n, src + j + 1, sizeof(V));
+    V l = (c << 1) | (p >> 63);
+    V r = (c >> 1) | (n << 63);
+    V out;
+    rule(l, c, r, out);
+    std::memcpy(dst + j, &out, sizeof(V));
+}
+
+template <class V, class Rule>
+AC_INLINE void step_vector_loop(const uint64_t* src, uint64_t* dst, size_t nw,
+                                const Rule& rule, size_t from) {
+    const size_t lanes = sizeof(V) / sizeof(uint64_t);
+    size_t j = from;
+    for (; j + lanes - 1 <= nw; j += lanes)
+        step_vector<V>(src, dst, j, rule);
+    step_scalar_loop(src, dst, nw, rule, j);
+}
+
+__attribute__((target("avx2")))
+inline void step_words_avx2(const uint64_t* src, uint64_t* dst, size_t nw,
+                            const RuleMasks& rm, size_t from = 1) {
+    step_vector_loop<u64x4>(src, dst, nw, MaskRule{rm}, from);
+}
+
+__attribute__((target("avx512f")))
+inline void step_words_avx512(const uint64_t* src, uint64_t* dst, size_t nw,
+                              const RuleMasks& rm, size_t from = 1) {
+    step_vector_loop<u64x8>(src, dst, nw, MaskRule{rm}, from);
+}
+#endif
+
+// ISA_AUTO : meilleur noyau disponible compte tenu de la taille de l'état
+enum KernelIsa { ISA_SCALAR, ISA_AVX2, ISA_AVX512, ISA_AUTO };
+
+typedef void (*StepKernel)(const uint64_t*, uint64_t*, size_t, const RuleMasks&, size_t);
+
+inline bool cpu_supports_isa(KernelIsa isa) {
+#if AC_ENGINE_X86
+    __builtin_cpu_init();
+    if (isa == ISA_AVX512) return __builtin_cpu_supports("avx512f");
+    if (isa == ISA_AVX2)   return __builtin_cpu_supports("avx2");
+#endif
+    return isa == ISA_SCALAR;
+}
+
+inline StepKernel step_kernel_for(KernelIsa isa) {
+#if AC_ENGINE_X86
+    if (isa == ISA_AVX512) return step_words_avx512;
+    if (isa == ISA_AVX2)   return step_words_avx2;
+#endif
+    (void)isa;
+    return step_words;
+}
+
+// Meilleur jeu d'instructions disponible, détecté une fois via CPUID :
+// le même binaire tourne donc sur toutes les machines.
+inline KernelIsa best_kernel_isa() {
+    static const KernelIsa isa = cpu_supports_isa(ISA_AVX512) ? ISA_AVX512
+                               : cpu_supports_isa(ISA_AVX2)   ? ISA_AVX2
+                               : ISA_SCALAR;
+    return isa;
+}
+
+// Sur les petits états, la boucle vectorielle ne ferait presque rien et le
+// changement de fréquence AVX-512 coûte plus qu'il ne rapporte.
+inline KernelIsa auto_kernel_isa(size_t nw) {
+    KernelIsa isa = best_kernel_isa();
+    if (isa == ISA_AVX512 && nw < 16) isa = ISA_AVX2;
+    if (isa == ISA_AVX2 && nw < 4) isa = ISA_SCALAR;
+    return isa;
+}
+
+inline const char* kernel_isa_name(KernelIsa isa) {
+    return isa == ISA_AVX512 ? "avx512" : isa == ISA_AVX2 ? "avx2"
+         : isa == ISA_AUTO ? "auto" : "scalar";
+}
+
+// Un noyau par règle et par jeu d'instructions, instancié à la compilation ;
+// la règle est choisie une seule fois par appel via une table de pointeurs.
+template <unsigned R>
+struct ScalarRuleKernel {
+    static void run(const uint64_t* src, uint64_t* dst, size_t nw, const RuleMasks&, size_t from) {
+        step_scalar_loop(src, dst, nw, FixedRule<R>(), from);
+    }
+};
+
+#if AC_ENGINE_X86
+template <unsigned R>
+struct Avx2RuleKernel {
+    __attribute__((target("avx2")))
+    static void run(const uint64_t* src, uint64_t* dst, size_t nw, const RuleMasks&, size_t from) {
+        step_vector_loop<u64x4>(src, dst, nw, FixedRule<R>(), from);
+    }
+};
+
+template <unsigned R>
+struct Avx512RuleKernel {
+    __attribute__((target("avx512f")))
+    static void run(const uint64_t* src, uint64_t* dst, size_t nw, const RuleMasks&, size_t from) {
+        step_vector_loop<u64x8>(src, dst, nw, FixedRule<R>(), from);
+    }
+};
+#endif
+
+template <template <unsigned> class Kernel, size_t... R>
+inline auto make_rule_kernel_table(std::index_sequence<R...>) {
+    typedef decltype(&Kernel<0>::run) Fn;
+    static const Fn table[] = { &Kernel<(unsigned)R>::run... };
+    return static_cast<const Fn*>(table);
+}
+
+inline StepKernel rule_kernel(uint32_t rule, KernelIsa isa) {
+    typedef std::make_index_sequence<256> AllRules;
+#if AC_ENGINE_X86
+    static const StepKernel* avx512 = make_rule_kernel_table<Avx512RuleKernel>(AllRules());
+    static const StepKernel* avx2 = make_rule_kernel_table<Avx2RuleKernel>(AllRules());
+    if (isa == ISA_AVX512) return avx512[rule & 0xFF];
+    if (isa == ISA_AVX2)   return avx2[rule & 0xFF];
+#endif
+    static const StepKernel* scalar = make_rule_kernel_table<ScalarRuleKernel>(AllRules());
+    (void)isa;
+    return scalar[rule & 0xFF];
+}
+
+// Fait évoluer `state` pendant `steps` générations avec le noyau `step`
+inline void evolve_with_kernel(PackedState& state, StepKernel step, const RuleMasks& rm,
+                               size_t steps, Boundary boundary) {
+    if (state.n == 0 || steps == 0) return;
+    size_t nw = state.nwords();
+    PackedState next(state.n);
+    for (size_t s = 0; s < steps; ++s) {
+        prepare_boundary(state, boundary);
+        step(state.buf.data(), next.buf.data(), nw, rm, 1);
+        next.mask_tail();
+        state.buf.swap(next.buf);
+    }
+    state.buf[0] = 0;
+    state.buf[nw + 1] = 0;
+}
+
+// ===========================================================
+// ====== AVANCE RAPIDE DES RÈGLES LINÉAIRES SUR GF(2) =======
+// ===========================================================
+
+// Les règles 60, 90, 102, 150 (et 0, 170, 204, 240) sont linéaires :
+// f(l, c, r) = a·l ⊕ b·c ⊕ d·r. Une génération est alors l'opérateur
+// T = a·G + b·I + d·D (G, D : décalage d'une cellule depuis la gauche / la
+// droite), et comme G et D commutent, T^(2^j) = a·G^(2^j) + b·I + d·D^(2^j)
+// sur GF(2) (les termes croisés s'annulent deux à deux). `steps`
+// générations coûtent donc un XOR de trois copies décalées par bit à 1 de
+// steps : O(n/64 · log steps) opérations sur mots au lieu de O(n/64 · steps).
+struct LinearRule {
+    bool left, center, right; // a, b, d
+};
+
+inline bool linear_rule(uint32_t rule, LinearRule& lr) {
+    rule &= 0xFF;
+    lr = LinearRule{((rule >> 4) & 1) != 0, ((rule >> 2) & 1) != 0, ((rule >> 1) & 1) != 0};
+    for (uint32_t idx = 0; idx < 8; ++idx) {
+        uint32_t v = (lr.left && (idx & 4)) ^ (lr.center && (idx & 2)) ^ (lr.right && (idx & 1));
+        if (((rule >> idx) & 1) != v) return false;
+    }
+    return true;
+}
+
+// dst[i] ^= src[i - k] (cellules de src au-delà de snw mots = 0) ; les bits
+// qui dépassent la fin de dst sont perdus, l'appelant masque la queue
+inline void xor_shifted_up(const uint64_t* src, size_t snw, uint64_t* dst, size_t dnw, size_t k) {
+    size_t q = k / 64, r = k % 64;
+    for (size_t j = q; j < dnw && j - q <= snw; ++j) {
+        uint64_t cur = j - q < snw ? src[j - q] : 0;
+        uint64_t prev = j > q ? src[j - q - 1] : 0;
+        dst[j] ^= r ? (cur << r) | (prev >> (64 - r)) : cur;
+    }
+}
+
+// dst[i] ^= src[i + k]
+inline void xor_shifted_down(const uint64_t* src, size_t snw, uint64_t* dst, size_t dnw, size_t k) {
+    size_t q = k / 64, r = k % 64;
+    for (size_t j = 0; j < dnw && j + q < snw; ++j) {
+        uint64_t cur = src[j + q];
+        uint64_t next = j + q + 1 < snw ? src[j + q + 1] : 0;
+        dst[j] ^= r ? (cur >> r) | (next << (64 - r)) : cur;
+    }
+}
+
+// T^(2^j) appliqué une fois, K = 2^j. Bord périodique : rotations de K mod n
+// (décalage vers le haut de K ⊕ vers le bas de n - K). Bord nul : décalages
+// avec des zéros, valable pour les règles à un seul voisin (a = 0 ou d = 0).
+inline void linear_power_step(PackedState& state, PackedState& next, const LinearRule& lr,
+                              size_t K, Boundary boundary) {
+    size_t n = state.n, nw = state.nwords();
+    const uint64_t* s = state.words();
+    uint64_t* t = next.words();
+    std::fill(t, t + nw, 0);
+    if (lr.center) std::copy(s, s + nw, t);
+    if (boundary == PERIODIC_BOUNDARY) {
+        K %= n;
+        if (lr.left) {
+            if (K == 0) for (size_t j = 0; j < nw; ++j) t[j] ^= s[j];
+            else { xor_shifted_up(s, nw, t, nw, K); xor_shifted_down(s, nw, t, nw, n - K); }
+        }
+        if (lr.right) {
+            if (K == 0) for (size_t j = 0; j < nw; ++j) t[j] ^= s[j];
+            else { xor_shifted_down(s, nw, t, nw, K); xor_shifted_up(s, nw, t, nw, n - K); }
+        }
+    } else if (K < n) {
+        if (lr.left) xor_shifted_up(s, nw, t, nw, K);
+        if (lr.right) xor_shifted_down(s, nw, t, nw, K);
+    }
+    next.mask_tail();
+    state.buf.swap(next.buf);
+}
+
+// Avance de `steps` générations une règle linéaire (cf. linear_rule).
+// Bord nul avec les deux voisins (90, 150) : l'état est plongé dans un anneau
+// de 2n + 2 cellules [s, 0, miroir de s, 0] ; la règle étant symétrique,
+// cette réflexion impaire reste invariante et les deux zéros jouent le rôle
+// des bords. On calcule en périodique puis on garde les n premières cellules.
+inline void evolve_packed_linear(PackedState& state, const LinearRule& lr, size_t steps,
+                                 Boundary boundary = ZERO_BOUNDARY) {
+    size_t n = state.n;
+    if (n == 0 || steps == 0) return;
+    if (boundary == ZERO_BOUNDARY && lr.left && lr.right) {
+        // miroir : mots dans l'ordre inverse, bits inversés dans chaque mot
+        // (cellule i -> 64·nw - 1 - i), puis recalé sur n - 1 - i
+        size_t nw = state.nwords();
+        std::vector<uint64_t> rev(nw), mirror(nw, 0);
+        for (size_t j = 0; j < nw; ++j) rev[j] = reverse_bits64(state.words()[nw - 1 - j]);
+        xor_shifted_down(rev.data(), nw, mirror.data(), nw, 64 * nw - n);
+
+        PackedState ring(2 * n + 2);
+        std::copy(state.words(), state.words() + nw, ring.words());
+        xor_shifted_up(mirror.data(), nw, ring.words(), ring.nwords(), n + 1);
+        evolve_packed_linear(ring, lr, steps, PERIODIC_BOUNDARY);
+        std::copy(ring.words(), ring.words() + state.nwords(), state.words());
+        state.mask_tail();
+        return;
+    }
+    PackedState next(n);
+    size_t K = 1;
+    for (size_t rest = steps; rest; rest >>= 1) {
+        if (rest & 1) linear_power_step(state, next, lr, K, boundary);
+        // K = 2^j, ramené modulo n en périodique, plafonné à n en bord nul
+        K = boundary == PERIODIC_BOUNDARY ? (2 * K) % n : std::min(2 * K, n);
+    }
+}
+
+// En dessous, la boucle génération par génération des noyaux reste plus
+// rapide que les log2(steps) passes de décalages (mesuré sur la règle 90) ;
+// l'anneau réfléchi du bord nul double la largeur et coûte une copie miroir.
+const size_t LINEAR_FAST_FORWARD_MIN_STEPS = 16;
+const size_t LINEAR_REFLECTED_MIN_STEPS = 128;
+
+inline bool use_linear_fast_forward(uint32_t rule, size_t steps, Boundary boundary,
+                                    LinearRule& lr) {
+    if (steps < LINEAR_FAST_FORWARD_MIN_STEPS || !linear_rule(rule, lr)) return false;
+    bool reflected = boundary == ZERO_BOUNDARY && lr.left && lr.right;
+    return !reflected || steps >= LINEAR_REFLECTED_MIN_STEPS;
+}
+
+// Fait évoluer `state` pendant `steps` générations (en place), avec le noyau
+// spécialisé pour `rule`. En ISA_AUTO, les règles linéaires passent par
+// l'avance rapide ci-dessus ; un isa explicite force toujours les noyaux.
+inline void evolve_packed(PackedState& state, uint32_t rule, size_t steps,
+                          Boundary boundary = ZERO_BOUNDARY,
+                          KernelIsa isa = ISA_AUTO) {
+    LinearRule lr;
+    if (isa == ISA_AUTO && use_linear_fast_forward(rule, steps, boundary, lr)) {
+        evolve_packed_linear(state, lr, steps, boundary);
+        return;
+    }
+    if (isa == ISA_AUTO) isa = auto_kernel_isa(state.nwords());
+    evolve_with_kernel(state, rule_kernel(rule, isa), RuleMasks(rule), steps, boundary);
+}
+
+// Même chose avec la règle évaluée à l'exécution (masques) : sert de
+// référence pour les noyaux spécialisés
+inline void evolve_packed_generic(PackedState& state, uint32_t rule, size_t steps,
+                                  Boundary boundary = ZERO_BOUNDARY,
+                                  KernelIsa isa = ISA_AUTO) {
+    if (isa == ISA_AUTO) isa = auto_kernel_isa(state.nwords());
+    evolve_with_kernel(state, step_kernel_for(isa), RuleMasks(rule), steps, boundary);
+}
+
+// ===========================================================
+// ============ RÈGLES DE RAYON 2 (TABLE DE 32 BITS) =========
+// ===========================================================
+
+// Une table de 32 bits ne se spécialise pas à la compilation comme les 256
+// règles de rayon 1 : la règle est évaluée par un arbre de multiplexeurs,
+// variable par variable (r2, r1, c, l1 puis l2), à partir de masques
+// précalculés. lo[i] = entrée 2i, diff[i] = entrée 2i ^ entrée 2i+1.
+struct RuleMasks2 {
+    uint64_t lo[16], diff[16];
+    explicit RuleMasks2(uint32_t rule) {
+        for (int i = 0; i < 16; ++i) {
+            uint64_t e0 = ((rule >> (2 * i)) & 1) ? ~0ULL : 0ULL;
+            uint64_t e1 = ((rule >> (2 * i + 1)) & 1) ? ~0ULL : 0ULL;
+            lo[i] = e0;
+            diff[i] = e0 ^ e1;
+        }
+    }
+};
+
+template <class W>
+AC_INLINE void rule2_words(const RuleMasks2& rm, const W& l2, const W& l1, const W& c,
+                           const W& r1, const W& r2, W& out) {
+    W t[16];
+#pragma GCC unroll 16
+    for (int i = 0; i < 16; ++i) t[i] = rm.lo[i] ^ (r2 & rm.diff[i]);
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) t[i] = t[2*i] ^ (r1 & (t[2*i] ^ t[2*i+1]));
+#pragma GCC unroll 4
+    for (int i = 0; i < 4; ++i) t[i] = t[2*i] ^ (c & (t[2*i] ^ t[2*i+1]));
+    for (int i = 0; i < 2; ++i) t[i] = t[2*i] ^ (l1 & (t[2*i] ^ t[2*i+1]));
+    out = t[0] ^ (l2 & (t[0] ^ t[1]));
+}
+
+// Même disposition que step_scalar_loop ; les deux voisins de chaque côté
+// viennent du même mot de garde (rayon 2 < 64)
+AC_INLINE void step_scalar_loop_r2(const uint64_t* src, uint64_t* dst, size_t nw,
+                                   const RuleMasks2& rm, size_t from) {
+    for (size_t j = from; j <= nw; ++j) {
+        uint64_t c = src[j], p = src[j-1], n = src[j+1];
+        rule2_words(rm, (c << 2) | (p >> 62), (c << 1) | (p >> 63), c,
+                    (c >> 1) | (n << 63), (c >> 2) | (n << 62), dst[j]);
+    }
+}
+
+inline void step_words_r2(const uint64_t* src, uint64_t* dst, size_t nw,
+                          const RuleMasks2& rm, size_t from = 1) {
+    step_scalar_loop_r2(src, dst, nw, rm, from);
+}
+
+#if AC_ENGINE_X86
+template <class V>
+AC_INLINE void step_vector_loop_r2(const uint64_t* src, uint64_t* dst, size_t nw,
+                                   const RuleMasks2& rm, size_t from) {
+    const size_t lanes = sizeof(V) / sizeof(uint64_t);
+    size_t j = from;
+    for (; j + lanes - 1 <= nw; j += lanes) {
+        V c, p, n, out;
+        std::memcpy(&c, src + j, sizeof(V));
+        std::memcpy(&p, src + j - 1, sizeof(V));
+        std::memcpy(&n, src + j + 1, sizeof(V));
+        rule2_words(rm, (c << 2) | (p >> 62), (c << 1) | (p >> 63), c,
+                    (c >> 1) | (n << 63), (c >> 2) | (n << 62), out);
+        std::memcpy(dst + j, &out, sizeof(V));
+    }
+    step_scalar_loop_r2(src, dst, nw, rm, j);
+}
+
+__attribute__((target("avx2")))
+inline void step_words_r2_avx2(const uint64_t* src, uint64_t* dst, size_t nw,
+                               const RuleMasks2& rm, size_t from = 1) {
+    step_vector_loop_r2<u64x4>(src, dst, nw, rm, from);
+}
+
+__attribute__((target("avx512f")))
+inline void step_words_r2_avx512(const uint64_t* src, uint64_t* dst, size_t nw,
+                                 const RuleMasks2& rm, size_t from = 1) {
+    step_vector_loop_r2<u64x8>(src, dst, nw, rm, from);
+}
+#endif
+
+typedef void (*StepKernel2)(const uint64_t*, uint64_t*, size_t, const RuleMasks2&, size_t);
+
+inline StepKernel2 step_kernel_r2_for(KernelIsa isa) {
+#if AC_ENGINE_X86
+    if (isa == ISA_AVX512) return step_words_r2_avx512;
+    if (isa == ISA_AVX2)   return step_words_r2_avx2;
+#endif
+    (void)isa;
+    return step_words_r2;
+}
+
+// Comme evolve_packed, pour une règle de rayon 2 (rule = table de 32 bits)
+inline void evolve_packed_r2(PackedState& state, uint32_t rule, size_t steps,
+                             Boundary boundary = ZERO_BOUNDARY,
+                             KernelIsa isa = ISA_AUTO) {
+    if (state.n == 0 || steps == 0) return;
+    if (isa == ISA_AUTO) isa = auto_kernel_isa(state.nwords());
+    StepKernel2 step = step_kernel_r2_for(isa);
+    RuleMasks2 rm(rule);
+    size_t nw = state.nwords();
+    PackedState next(state.n);
+    for (size_t s = 0; s < steps; ++s) {
+        prepare_boundary(state, boundary, 2);
+        step(state.buf.data(), next.buf.data(), nw, rm, 1);
+        next.mask_tail();
+        state.buf.swap(next.buf);
+    }
+    state.buf[0] = 0;
+    state.buf[nw + 1] = 0;
+}
+
+// Rayon 1 (règle 0..255) ou 2 (table de 32 bits)
+inline void evolve_packed_radius(PackedState& state, uint32_t rule, int radius, size_t steps,
+                                 Boundary boundary = ZERO_BOUNDARY) {
+    if (radius == 2) evolve_packed_r2(state, rule, steps, boundary);
+    else             evolve_packed(state, rule, steps, boundary);
+}
+
+// ===========================================================
+// ===== BLOCAGE TEMPOREL : 4 GÉNÉRATIONS PAR PASSAGE (LUT) ==
+// ===========================================================
+
+// Une cellule ne dépend que des cellules à distance <= k, k générations plus
+// tôt. Une table par règle associe donc à une fenêtre de 16 cellules
+// (bit j = cellule p-4+j) les 8 cellules centrales (bit i = cellule p+i)
+// LUT_STEPS = 4 générations plus tard : un seul passage mémoire par octet de
+// l'état fait avancer de 4 générations. Les tables (64 Ko) sont construites à
+// la première utilisation de chaque règle puis gardées en cache.
+const size_t LUT_STEPS = 4;
+
+inline const uint8_t* lut4_table(uint32_t rule) {
+    static std::mutex mtx;
+    static std::unique_ptr<uint8_t[]> tables[256];
+    std::lock_guard<std::mutex> lock(mtx);
+    std::unique_ptr<uint8_t[]>& table = tables[rule & 0xFF];
+    if (!table) {
+        table.reset(new uint8_t[1 << 16]);
+        RuleMasks rm(rule);
+        for (uint32_t w = 0; w < (1u << 16); ++w) {
+            // les bords de la fenêtre se dégradent d'une cellule par
+            // génération, les 8 cellules centrales restent exactes
+            uint64_t x = w;
+            for (size_t s = 0; s < LUT_STEPS; ++s)
+                x = rule_word(rm, x << 1, x, x >> 1);
+            table[w] = (uint8_t)(x >> LUT_STEPS);
+        }
+    }
+    return table.get();
+}
+
+// Copie des cellules [from, from+len) de src dans un nouvel état
+inline PackedState slice_cells(const PackedState& src, size_t from, size_t len) {
+    PackedState out(len);
+    for (size_t i = 0; i < len; ++i)
+        if (src.get(from + i)) out.set(i, 1);
+    return out;
+}
+
+// Une passe de LUT_STEPS générations (n >= 4 * LUT_STEPS). L'état est relu
+// octet par octet (cellule i = octet i/8, bit i%8 : machine little-endian).
+// ext est un tampon de travail réutilisé d'une passe à l'autre.
+inline void lut4_pass(PackedState& state, uint32_t rule, const uint8_t* lut,
+                      Boundary boundary, std::vector<uint8_t>& ext) {
+    const size_t k = LUT_STEPS;
+    size_t n = state.n;
+    size_t nb = (n + 7) / 8;
+    uint8_t* body = reinterpret_cast<uint8_t*>(state.words());
+
+    // ext = [8 cellules de bord gauche][état][bord droit], lu par 32 bits
+    ext.assign(nb + 8, 0);
+    std::memcpy(ext.data() + 1, body, nb);
+
+    // Bord nul : dans la table, les cellules hors de l'état évoluent au lieu
+    // de rester à 0, ce qui fausse les k cellules de chaque extrémité. On les
+    // recalcule à part sur deux petits états de 3k cellules.
+    PackedState left, right;
+    if (boundary == PERIODIC_BOUNDARY) {
+        for (size_t i = 0; i < 8; ++i)
+            if (state.get(n - 8 + i)) ext[0] |= (uint8_t)(1u << i);
+        for (size_t i = 0; i < 32; ++i) {
+            size_t p = 8 + n + i;
+            if (state.get(i % n)) ext[p / 8] |= (uint8_t)(1u << (p % 8));
+        }
+    } else {
+        left = slice_cells(state, 0, 3 * k);
+        right = slice_cells(state, n - 3 * k, 3 * k);
+        evolve_packed(left, rule, k, ZERO_BOUNDARY);
+        evolve_packed(right, rule, k, ZERO_BOUNDARY);
+    }
+
+    for (size_t b = 0; b < nb; ++b) {
+        uint32_t window;
+        std::memcpy(&window, ext.data() + b, sizeof(window));
+        body[b] = lut[(window >> 4) & 0xFFFF];
+    }
+    state.mask_tail();
+
+    if (boundary == ZERO_BOUNDARY) {
+        for (size_t i = 0; i < k; ++i) {
+            state.set(i, left.get(i));
+            state.set(n - k + i, right.get(2 * k + i));
+        }
+    }
+}
+
+// Variante de evolve_packed qui avance de LUT_STEPS générations par passage
+// mémoire ; le reste (steps % LUT_STEPS) et les très petits états passent
+// par les noyaux génération par génération. Résultat identique bit à bit.
+// Mesuré : 3 à 6 fois plus lent que les noyaux sur mots (une consultation
+// de table par octet contre 64 à 512 cellules par opération), donc réservé
+// aux cibles sans noyau vectoriel ; evolve_packed reste le chemin par défaut.
+inline void evolve_packed_lut(PackedState& state, uint32_t rule, size_t steps,
+                              Boundary boundary = ZERO_BOUNDARY) {
+    if (state.n < 4 * LUT_STEPS) {
+        evolve_packed(state, rule, steps, boundary);
+        return;
+    }
+    const uint8_t* lut = lut4_table(rule);
+    std::vector<uint8_t> ext;
+    for (size_t s = 0; s + LUT_STEPS <= steps; s += LUT_STEPS)
+        lut4_pass(state, rule, lut, boundary, ext);
+    evolve_packed(state, rule, steps % LUT_STEPS, boundary);
+}
+
+// ===========================================================
+// ================ SORTIE DU HASH ===========================
+// ===========================================================
+
+// nbits (<= 256) bits de hash, hash_bits[i] = state[i % n], dans un Digest :
+// bit de poids fort de l'octet 0 = hash_bits[0]. Les octets au-delà de
+// nbits restent à zéro, ainsi que tout le digest si l'état est vide.
+inline Digest packed_to_digest(const PackedState& s, size_t nbits) {
+    Digest d{};
+    if (s.n == 0) return d;
+    // octets entièrement dans l'état : les cellules sont rangées bit de poids
+    // faible d'abord, il suffit d'inverser chaque octet
+    size_t direct = std::min(nbits / 8, s.n / 8);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(s.words());
+    for (size_t k = 0; k < direct; ++k)
+        d[k] = reverse_bits8(bytes[k]);
+    for (size_t i = direct * 8; i < nbits; ++i)
+        if (s.get(i % s.n)) d[i / 8] |= (uint8_t)(0x80 >> (i % 8));
+    return d;
+}
+
+// Produit nbits (<= 256) bits de hash en hexadécimal majuscule, 4 bits par
+// caractère, premier bit = poids fort.
+inline std::string packed_to_hex(const PackedState& s, size_t nbits) {
+    return digest_hex(packed_to_digest(s, nbits), nbits / 4, true);
+}
@@ -0,0 +1,199 @@
+// ac_incremental.h
+// Hachage AC incrémental pour le minage : seuls les chiffres du nonce, à la
+// fin du message index||previousHash||timestamp||data||nonce, changent d'un
+// essai à l'autre.
+//
+// Avec le bord nul, la cellule i à la génération t ne dépend que des cellules
+// [i-t, i+t] de l'état initial : toute cellule à gauche de P - t (P = nombre
+// de bits du préfixe fixe) est la même pour tous les nonces. On fait donc
+// évoluer une seule fois le préfixe seul, et on garde :
+//   - l'état final du préfixe (cellules < W0, avec W0 <= P - steps) ;
+//   - pour chaque génération t, la cellule W0-1, voisin gauche exact de la
+//     fenêtre [W0, n) qui contient le cône de lumière du nonce.
+// Chaque essai ne fait plus évoluer que cette fenêtre de steps + 64 cellules
+// environ (plus les chiffres du nonce) : O(steps²) au lieu de O(n·steps).
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "ac_engine.h"
+#include "miner.h"
+
+// steps générations de `cur` (bord droit nul) sans allocation : `next` est
+// un tampon de même taille. guard[t] donne le voisin gauche de la cellule 0 à
+// la génération t (nullptr = bord nul).
+inline void evolve_with_guard(PackedState& cur, PackedState& next, uint32_t rule,
+                              const RuleMasks& rm, size_t steps, const uint8_t* guard) {
+    size_t nw = cur.nwords();
+    if (nw == 0) return;
+    StepKernel step = rule_kernel(rule, auto_kernel_isa(nw));
+    for (size_t t = 0; t < steps; ++t) {
+        cur.buf[0] = guard ? (uint64_t)guard[t] << 63 : 0;
+        cur.buf[nw + 1] = 0;
+        step(cur.buf.data(), next.buf.data(), nw, rm, 1);
+        next.mask_tail();
+        cur.buf.swap(next.buf);
+    }
+    cur.buf[0] = 0;
+}
+
+class AcNonceHasher {
+public:
+    // Même résultat que ac_hash(prefix + to_string(nonce), rule, steps) des
+    // exercices (bord nul, 256 bits de sortie)
+    AcNonceHasher(const std::string& prefix, uint32_t rule, size_t steps,
+                  NonceEncoder encode = decimal_nonce)
+        : rule_(rule), steps_(steps), P_(prefix.size() * 8), rm_(rule), encode_(encode) {
+        W0_ = P_ > steps_ ? ((P_ - steps_) / 64) * 64 : 0;
+
+        PackedState pre = pack_text(prefix);
+        window0_ = slice_words(pre, W0_);
+        guard_.assign(steps_, 0);
+        for (size_t t = 0; t < steps_; ++t) {
+            if (W0_ > 0) guard_[t] = (uint8_t)pre.get(W0_ - 1);
+            evolve_packed(pre, rule_, 1, ZERO_BOUNDARY);
+        }
+        final_ = pre;
+    }
+
+    Digest hash(int64_t nonce) {
+        char bytes[NONCE_MAX_BYTES];
+        return hash_suffix(bytes, encode_(nonce, bytes));
+    }
+
+    // Hash de prefix + suffix (octets quelconques, ajoutés après le préfixe)
+    Digest hash_suffix(const char* suffix, size_t len) {
+        evolve_window(suffix, len);
+        return packed_to_digest(output_cells(), 256);
+    }
+
+    size_t window_cells() const { return win_.n; }
+
+protected:
+    // Fenêtre initiale = cellules [W0, P) du préfixe + octets du suffixe,
+    // puis steps générations avec le voisin gauche mis en cache
+    void evolve_window(const char* suffix, size_t len) {
+        n_ = P_ + len * 8;
+        size_t cells = n_ - W0_;
+        if (win_.n != cells) {
+            win_ = PackedState(cells);
+            next_ = PackedState(cells);
+        } else {
+            std::fill(win_.buf.begin(), win_.buf.end(), 0);
+        }
+        std::memcpy(win_.words(), window0_.words(), window0_.nwords() * sizeof(uint64_t));
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(win_.words()) + (P_ - W0_) / 8;
+        for (size_t k = 0; k < len; ++k)
+            bytes[k] = reverse_bits8((uint8_t)suffix[k]);
+
+        evolve_with_guard(win_, next_, rule_, rm_, steps_, guard_.data());
+    }
+
+    // Les cellules utiles au hash (les 256 premières, ou tout l'état s'il est
+    // plus court) : mots < W0 tirés du cache, le reste de la fenêtre
+    const PackedState& output_cells() {
+        size_t need = std::min<size_t>(n_, 256);
+        if (out_.n != need) out_ = PackedState(need);
+        for (size_t w = 0; w < out_.nwords(); ++w)
+            out_.words()[w] = (w * 64 < W0_) ? final_.words()[w]
+                                              : win_.words()[w - W0_ / 64];
+        out_.mask_tail();
+        return out_;
+    }
+
+    static PackedState slice_words(const PackedState& s, size_t fromCell) {
+        PackedState out(s.n - fromCell);
+        std::memcpy(out.words(), s.words() + fromCell / 64, out.nwords() * sizeof(uint64_t));
+        return out;
+    }
+
+    uint32_t rule_;
+    size_t steps_;
+    size_t P_;          // cellules du préfixe
+    size_t W0_;         // début de la fenêtre recalculée (multiple de 64)
+    size_t n_ = 0;      // cellules du message courant
+    RuleMasks rm_;
+    NonceEncoder encode_;
+    PackedState window0_;        // cellules [W0, P) à la génération 0
+    PackedState final_;          // préfixe seul après steps générations
+    std::vector<uint8_t> guard_; // cellule W0-1 à chaque génération
+    PackedState win_, next_, out_;
+};
+
+// ===========================================================
+// ======== SONDE DE DIFFICULTÉ (REJET ANTICIPÉ) =============
+// ===========================================================
+
+// Une cible impose que les m premiers bits du hash soient nuls (m = bits de
+// tête nuls de la cible), c'est-à-dire les cellules state[i % n] pour i < m :
+// condition nécessaire, testée avant la comparaison complète. Avec le bord nul,
+// ces cellules ne dépendent que des cellules [0, m + steps) du message : la
+// sonde ne fait évoluer que ce cône arrière et rejette la plupart des nonces
+// sans calculer le hash complet. Si le cône tient entièrement dans le préfixe
+// fixe, le résultat ne dépend même pas du nonce : il est calculé une seule
+// fois, et un échec signifie qu'aucun nonce ne peut atteindre la cible.
+class AcDifficultyProbe {
+public:
+    // zeroBits : nombre de bits de tête du hash qui doivent être nuls
+    AcDifficultyProbe(const std::string& prefix, uint32_t rule, size_t steps, size_t zeroBits,
+                      NonceEncoder encode = decimal_nonce)
+        : prefix_(prefix), rule_(rule), steps_(steps), m_(zeroBits), rm_(rule),
+          encode_(encode) {
+        P_ = prefix.size() * 8;
+        constant_ = m_ + steps_ <= P_;
+        if (constant_) constantResult_ = evaluate("", 0);
+    }
+
+    // Faux si le résultat de la sonde est le même pour tous les nonces
+    bool depends_on_nonce() const { return !constant_; }
+
+    // Vrai si aucun nonce ne peut satisfaire la cible
+    bool unreachable() const { return constant_ && !constantResult_; }
+
+    bool passes(int64_t nonce) {
+        if (constant_) return constantResult_;
+        char bytes[NONCE_MAX_BYTES];
+        return evaluate(bytes, encode_(nonce, bytes));
+    }
+
+private:
+    // Les m premiers bits du hash de prefix + suffix sont-ils tous nuls ?
+    bool evaluate(const char* suffix, size_t len) {
+        size_t n = P_ + len * 8;
+        if (n == 0) return m_ == 0;
+        size_t cells = std::min(n, m_ + steps_);
+        if (cur_.n != cells) {
+            cur_ = PackedState(cells);
+            next_ = PackedState(cells);
+        } else {
+            std::fill(cur_.buf.begin(), cur_.buf.end(), 0);
+        }
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(cur_.words());
+        for (size_t k = 0; k * 8 < cells; ++k) {
+            uint8_t c = k < prefix_.size() ? (uint8_t)prefix_[k] : (uint8_t)suffix[k - prefix_.size()];
+            bytes[k] = reverse_bits8(c);
+        }
+        cur_.mask_tail();
+
+        // les cellules au-delà de m + steps sont tronquées : leur absence ne
+        // peut atteindre les m premières cellules en `steps` générations
+        evolve_with_guard(cur_, next_, rule_, rm_, steps_, nullptr);
+        for (size_t i = 0; i < m_; ++i)
+            if (cur_.get(i % n)) return false;
+        return true;
+    }
+
+    std::string prefix_;
+    uint32_t rule_;
+    size_t steps_;
+    size_t m_;       // bits de hash testés
+    size_t P_;       // cellules du préfixe
+    RuleMasks rm_;
+    NonceEncoder encode_;
+    bool constant_;
+    bool constantResult_ = false;
+    PackedState cur_, next_;
+};
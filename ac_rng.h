@@ -0,0 +1,172 @@
+// ac_rng.h
+// Générateur pseudo-aléatoire à partir de la règle 30 : on lit la colonne
+// centrale d'un anneau de AC_RNG_CELLS cellules, une génération par bit.
+//
+// Un seul automate ne donnerait qu'un bit par génération. Le générateur
+// fait donc évoluer AC_RNG_LANES anneaux indépendants à la fois, en plans de
+// bits comme ac_bitslice.h : le plan i (AC_RNG_PLANE_WORDS mots) contient la
+// cellule i de tous les anneaux, et une génération s'écrit
+//     next[i] = plane[i-1] ^ (plane[i] | plane[i+1])
+// soit un OU et un XOR vectoriels par cellule, sans décalage. Chaque
+// génération produit AC_RNG_PLANE_WORDS mots de sortie (le plan central).
+// Le plan a la même largeur quel que soit le jeu d'instructions : la suite
+// produite ne dépend que de la graine, pas de la machine.
+//
+// Sur un anneau de n cellules, les cycles de la règle 30 ont une longueur
+// d'environ 2^(0.6 n) générations (mesurée pour n <= 34) : avec 128 cellules,
+// bien au-delà de ce qu'une analyse peut consommer.
+//
+// Flux : Rule30Rng(graine, flux) donne une suite différente pour chaque
+// numéro de flux (un par thread, par exemple) ; split() dérive un nouveau
+// générateur de la sortie courante. La règle 30 n'étant pas linéaire, il
+// n'existe pas de saut rapide à la manière des règles additives (voir
+// evolve_packed_linear) : les flux sont séparés par leur état initial.
+//
+// Le générateur satisfait UniformRandomBitGenerator (std::shuffle,
+// distributions de <random>...). Ce n'est pas un générateur cryptographique.
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include "ac_engine.h"
+
+const size_t AC_RNG_CELLS = 128;
+const size_t AC_RNG_PLANE_WORDS = 4;
+const size_t AC_RNG_LANES = 64 * AC_RNG_PLANE_WORDS;
+const size_t AC_RNG_BLOCK_STEPS = 16; // générations par remplissage du tampon
+
+// AC_RNG_BLOCK_STEPS générations de la règle 30 sur les plans de src
+// (plans de garde en 0 et AC_RNG_CELLS + 1), résultat dans src ou dst selon
+// la parité ; le plan central de chaque génération va dans out.
+// V : vecteur d'un ou plusieurs mots ; le plan est traité par tranches de V.
+template <class V>
+AC_INLINE uint64_t* ac_rng_block(uint64_t* src, uint64_t* dst, uint64_t* out) {
+    const size_t N = AC_RNG_CELLS, L = AC_RNG_PLANE_WORDS, VW = sizeof(V) / 8;
+    uint64_t* __restrict s = src;
+    uint64_t* __restrict t = dst;
+    for (size_t g = 0; g < AC_RNG_BLOCK_STEPS; ++g) {
+        // anneau : gardes recopiées de l'autre extrémité
+        std::memcpy(s, s + N * L, L * 8);
+        std::memcpy(s + (N + 1) * L, s + L, L * 8);
+        for (size_t j = 0; j < L; j += VW) {
+            V l, c, r;
+            std::memcpy(&l, s + j, sizeof(V));
+            std::memcpy(&c, s + L + j, sizeof(V));
+            for (size_t i = 1; i <= N; ++i) {
+                std::memcpy(&r, s + (i + 1) * L + j, sizeof(V));
+                V o = l ^ (c | r);
+                std::memcpy(t + i * L + j, &o, sizeof(V));
+                l = c;
+                c = r;
+            }
+        }
+        std::memcpy(out + g * L, t + (N / 2) * L, L * 8);
+        std::swap(s, t);
+    }
+    return s;
+}
+
+#if AC_ENGINE_X86
+__attribute__((target("avx2")))
+inline uint64_t* ac_rng_block_avx2(uint64_t* src, uint64_t* dst, uint64_t* out) {
+    return ac_rng_block<u64x4>(src, dst, out);
+}
+#endif
+
+inline uint64_t* ac_rng_block_sse(uint64_t* src, uint64_t* dst, uint64_t* out) {
+    typedef uint64_t u64x2 __attribute__((vector_size(16)));
+    return ac_rng_block<u64x2>(src, dst, out);
+}
+
+typedef uint64_t* (*AcRngKernel)(uint64_t*, uint64_t*, uint64_t*);
+
+inline AcRngKernel ac_rng_kernel() {
+#if AC_ENGINE_X86
+    if (cpu_supports_isa(ISA_AVX2)) return ac_rng_block_avx2;
+#endif
+    return ac_rng_block_sse;
+}
+
+class Rule30Rng {
+public:
+    typedef uint64_t result_type;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~0ULL; }
+
+    explicit Rule30Rng(uint64_t seed = 0, uint64_t stream = 0) : kernel_(ac_rng_kernel()) {
+        // état initial : splitmix64 sur (graine, flux) ; deux flux d'une même
+        // graine partent toujours d'états différents
+        uint64_t x = seed;
+        x = splitmix64(x) ^ stream;
+        std::memset(planes_, 0, sizeof(planes_));
+        for (size_t i = PLANE; i < (AC_RNG_CELLS + 1) * PLANE; ++i)
+            planes_[0][i] = splitmix64(x);
+    }
+
+    // La copie reprend la suite au même point (cur_ pointe dans planes_)
+    Rule30Rng(const Rule30Rng& o) { *this = o; }
+    Rule30Rng& operator=(const Rule30Rng& o) {
+        std::memcpy(planes_, o.planes_, sizeof(planes_));
+        std::memcpy(out_, o.out_, sizeof(out_));
+        cur_ = o.cur_ == o.planes_[0] ? planes_[0] : planes_[1];
+        pos_ = o.pos_;
+        kernel_ = o.kernel_;
+        return *this;
+    }
+
+    uint64_t operator()() {
+        if (pos_ == OUT_WORDS) refill();
+        return out_[pos_++];
+    }
+
+    // Entier uniforme dans [0, n), n > 0 : multiplication 64 x 64 -> 128
+    // bits avec rejet (méthode de Lemire), sans biais de modulo
+    uint64_t below(uint64_t n) {
+        unsigned __int128 m = (unsigned __int128)(*this)() * n;
+        if ((uint64_t)m < n) {
+            uint64_t threshold = -n % n;
+            while ((uint64_t)m < threshold)
+                m = (unsigned __int128)(*this)() * n;
+        }
+        return (uint64_t)(m >> 64);
+    }
+
+    // Réel uniforme dans [0, 1) (53 bits)
+    double uniform() { return (double)((*this)() >> 11) * 0x1.0p-53; }
+
+    // Remplit out de n mots, par blocs entiers quand c'est possible
+    void fill(uint64_t* out, size_t n) {
+        for (; n > 0 && pos_ < OUT_WORDS; --n) *out++ = out_[pos_++];
+        for (; n >= OUT_WORDS; n -= OUT_WORDS, out += OUT_WORDS)
+            step_block(out);
+        for (; n > 0; --n) *out++ = (*this)();
+    }
+
+    // Nouveau générateur indépendant, tiré de la suite courante
+    Rule30Rng split() {
+        uint64_t seed = (*this)();
+        return Rule30Rng(seed, (*this)());
+    }
+
+private:
+    static const size_t PLANE = AC_RNG_PLANE_WORDS;
+    static const size_t OUT_WORDS = AC_RNG_BLOCK_STEPS * AC_RNG_PLANE_WORDS;
+
+    void step_block(uint64_t* out) {
+        uint64_t* other = cur_ == planes_[0] ? planes_[1] : planes_[0];
+        cur_ = kernel_(cur_, other, out);
+    }
+
+    void refill() {
+        step_block(out_);
+        pos_ = 0;
+    }
+
+    alignas(32) uint64_t planes_[2][(AC_RNG_CELLS + 2) * AC_RNG_PLANE_WORDS];
+    uint64_t out_[OUT_WORDS];
+    uint64_t* cur_ = planes_[0];
+    size_t pos_ = OUT_WORDS;
+    AcRngKernel kernel_;
+};
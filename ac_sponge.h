@@ -0,0 +1,140 @@
+// ac_sponge.h
+// AC_HASH en flux (construction éponge) pour les grandes entrées.
+//
+// ac_hash fait évoluer un état d'une cellule par bit du message : mémoire et
+// coût par génération croissent avec la taille de l'entrée, d'où la
+// troncature à 512 bits d'exercice4 (deux messages qui ne diffèrent qu'après
+// 64 octets avaient le même hash). Ici l'état a une largeur fixe de
+// AC_SPONGE_CELLS cellules, en bord périodique :
+//   - les AC_SPONGE_RATE premiers bits (le "débit") reçoivent le message par
+//     XOR, un bloc de 32 octets à la fois, suivi de `rounds` générations ;
+//   - les bits restants (la "capacité") ne sont jamais écrits directement ;
+//   - finalize() ajoute le bourrage 10*1, puis AC_SPONGE_CELLS générations à
+//     vide pour que chaque bit du message atteigne toute la largeur, et
+//     renvoie les 256 premières cellules.
+// update() peut être appelé autant de fois que voulu : la mémoire est
+// constante et le débit (octets/s) ne dépend pas de la taille de l'entrée.
+// Les octets sont lus MSB en premier, comme pack_bytes.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <string>
+#include <vector>
+#include "ac_engine.h"
+#include "digest.h"
+
+const size_t AC_SPONGE_CELLS = 512;
+const size_t AC_SPONGE_RATE = 256;
+const size_t AC_SPONGE_BLOCK_BYTES = AC_SPONGE_RATE / 8;
+
+class AcSponge {
+public:
+    AcSponge(uint32_t rule = 30, size_t rounds = 8)
+        : rounds_(rounds), rm_(rule),
+          step_(rule_kernel(rule, auto_kernel_isa(NW))),
+          state_(AC_SPONGE_CELLS), next_(AC_SPONGE_CELLS) {
+        // état initial non nul et propre à (règle, rounds) : avec la règle 30,
+        // un état nul le resterait et les blocs nuls en tête seraient ignorés
+        uint64_t x = ((uint64_t)rule << 32) ^ rounds;
+        for (size_t i = 0; i < NW; ++i) state_.words()[i] = splitmix64(x);
+    }
+
+    void update(const char* data, size_t len) {
+        if (pending_ > 0) {
+            size_t take = std::min(len, AC_SPONGE_BLOCK_BYTES - pending_);
+            std::memcpy(block_ + pending_, data, take);
+            pending_ += take;
+            data += take;
+            len -= take;
+            if (pending_ < AC_SPONGE_BLOCK_BYTES) return;
+            absorb(block_);
+            pending_ = 0;
+        }
+        // blocs complets lus directement dans l'entrée, sans copie
+        for (; len >= AC_SPONGE_BLOCK_BYTES; data += AC_SPONGE_BLOCK_BYTES, len -= AC_SPONGE_BLOCK_BYTES)
+            absorb(data);
+        std::memcpy(block_, data, len);
+        pending_ = len;
+    }
+
+    void update(const std::string& s) { update(s.data(), s.size()); }
+
+    // Reprend l'état de `other` (même nombre de cellules) dans les tampons
+    // existants, sans allocation : repartir à chaque nonce d'une éponge qui a
+    // déjà absorbé le préfixe
+    void reset_from(const AcSponge& other) {
+        rounds_ = other.rounds_;
+        rm_ = other.rm_;
+        step_ = other.step_;
+        std::copy(other.state_.buf.begin(), other.state_.buf.end(), state_.buf.begin());
+        std::memcpy(block_, other.block_, other.pending_);
+        pending_ = other.pending_;
+    }
+
+    // Termine le hash ; l'objet ne doit plus être utilisé ensuite
+    Digest finalize() {
+        // bourrage 10*1 : un bit 1 après le message, un bit 1 en fin de bloc
+        std::memset(block_ + pending_, 0, AC_SPONGE_BLOCK_BYTES - pending_);
+        block_[pending_] |= (char)0x80;
+        block_[AC_SPONGE_BLOCK_BYTES - 1] |= 0x01;
+        absorb(block_);
+        evolve(AC_SPONGE_CELLS);
+        return packed_to_digest(state_, 256);
+    }
+
+private:
+    static const size_t NW = AC_SPONGE_CELLS / 64;
+
+    // 32 octets -> 256 cellules XORées dans le débit. Un mot lu en
+    // petit-boutiste place l'octet k aux bits 8k..8k+7 ; il reste à inverser
+    // les bits de chaque octet (MSB en premier), ici sur le mot entier.
+    void absorb(const char* block) {
+        uint64_t* w = state_.words();
+        for (size_t i = 0; i < AC_SPONGE_RATE / 64; ++i) {
+            uint64_t x;
+            std::memcpy(&x, block + 8 * i, 8);
+            x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+            x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+            x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+            w[i] ^= x;
+        }
+        evolve(rounds_);
+    }
+
+    // Comme evolve_with_kernel, sans allouer de tampon à chaque bloc
+    void evolve(size_t steps) {
+        for (size_t s = 0; s < steps; ++s) {
+            prepare_boundary(state_, PERIODIC_BOUNDARY);
+            step_(state_.buf.data(), next_.buf.data(), NW, rm_, 1);
+            state_.buf.swap(next_.buf);
+        }
+    }
+
+    size_t rounds_;
+    RuleMasks rm_;
+    StepKernel step_;
+    PackedState state_, next_;
+    char block_[AC_SPONGE_BLOCK_BYTES];
+    size_t pending_ = 0;
+};
+
+inline Digest ac_sponge_hash(const char* data, size_t len, uint32_t rule = 30, size_t rounds = 8) {
+    AcSponge sponge(rule, rounds);
+    sponge.update(data, len);
+    return sponge.finalize();
+}
+
+// Hash d'un flux (fichier...) lu par morceaux de 64 Ko
+inline Digest ac_sponge_stream(std::istream& in, uint32_t rule = 30, size_t rounds = 8) {
+    AcSponge sponge(rule, rounds);
+    std::vector<char> chunk(1 << 16);
+    while (in) {
+        in.read(chunk.data(), chunk.size());
+        sponge.update(chunk.data(), (size_t)in.gcount());
+    }
+    return sponge.finalize();
+}
@@ -0,0 +1,94 @@
+// ac_tree.h
+// Mode arbre de l'éponge AC (ac_sponge.h) pour les charges de plusieurs Mo.
+//
+// L'éponge est séquentielle : un gros bloc de données n'occupe qu'un cœur.
+// Ici l'entrée est découpée en feuilles de AC_TREE_LEAF_BYTES octets, hachées
+// indépendamment par un groupe de threads, puis combinées deux à deux :
+//   feuille : H(0x00 || octets de la feuille)
+//   nœud    : H(0x01 || gauche || droite)     (un nœud seul remonte tel quel)
+//   racine  : H(0x02 || sommet || longueur totale sur 8 octets)
+// Le préfixe de chaque entrée sépare les domaines (une feuille ne peut pas
+// passer pour un nœud), et la forme de l'arbre ne dépend que de la longueur :
+// le résultat est le même quel que soit le nombre de threads.
+//
+// Compilation : g++ -O2 -std=c++17 -pthread ...
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ac_sponge.h"
+#include "digest.h"
+#include "miner.h"
+
+const size_t AC_TREE_LEAF_BYTES = 64 * 1024;
+
+enum AcTreeDomain : char { AC_TREE_LEAF = 0x00, AC_TREE_NODE = 0x01, AC_TREE_ROOT = 0x02 };
+
+// Appelle fn(i) pour i dans [0, count), indices distribués un par un aux
+// threads (threads = 0 : un par cœur)
+template <class Fn>
+void parallel_for_index(size_t count, unsigned threads, Fn fn) {
+    if (threads == 0) threads = default_mining_threads();
+    if (threads > count) threads = (unsigned)count;
+    std::atomic<size_t> next(0);
+    auto run = [&]() {
+        for (size_t i; (i = next.fetch_add(1)) < count;) fn(i);
+    };
+    if (threads <= 1) {
+        run();
+        return;
+    }
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t)
+        pool.emplace_back(run);
+    for (std::thread& th : pool)
+        th.join();
+}
+
+inline Digest ac_tree_hash(const char* data, size_t len, uint32_t rule = 30,
+                           size_t rounds = 8, unsigned threads = 0) {
+    // une feuille vide pour l'entrée vide
+    size_t leaves = len == 0 ? 1 : (len + AC_TREE_LEAF_BYTES - 1) / AC_TREE_LEAF_BYTES;
+    std::vector<Digest> level(leaves);
+    parallel_for_index(leaves, threads, [&](size_t i) {
+        size_t from = i * AC_TREE_LEAF_BYTES;
+        const char domain = AC_TREE_LEAF;
+        AcSponge sponge(rule, rounds);
+        sponge.update(&domain, 1);
+        sponge.update(data + from, std::min(AC_TREE_LEAF_BYTES, len - from));
+        level[i] = sponge.finalize();
+    });
+
+    while (level.size() > 1) {
+        std::vector<Digest> up((level.size() + 1) / 2);
+        parallel_for_index(level.size() / 2, threads, [&](size_t i) {
+            const char domain = AC_TREE_NODE;
+            AcSponge sponge(rule, rounds);
+            sponge.update(&domain, 1);
+            sponge.update((const char*)level[2 * i].data(), DIGEST_BYTES);
+            sponge.update((const char*)level[2 * i + 1].data(), DIGEST_BYTES);
+            up[i] = sponge.finalize();
+        });
+        if (level.size() & 1) up.back() = level.back();
+        level.swap(up);
+    }
+
+    char length[8];
+    for (int k = 0; k < 8; ++k) length[k] = (char)((uint64_t)len >> (8 * k));
+    const char domain = AC_TREE_ROOT;
+    AcSponge sponge(rule, rounds);
+    sponge.update(&domain, 1);
+    sponge.update((const char*)level[0].data(), DIGEST_BYTES);
+    sponge.update(length, sizeof(length));
+    return sponge.finalize();
+}
+
+inline Digest ac_tree_hash(const std::string& data, uint32_t rule = 30,
+                           size_t rounds = 8, unsigned threads = 0) {
+    return ac_tree_hash(data.data(), data.size(), rule, rounds, threads);
+}
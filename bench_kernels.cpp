@@ -0,0 +1,415 @@
+// bench_kernels.cpp
+// Microbenchmarks des étapes d'un hash de bloc, mesurées séparément :
+//   - evolve_reference : evolve() sur vector<int> (version des exercices) ;
+//   - pack, evolve_packed (noyau choisi automatiquement et noyau générique
+//     scalaire), digest : les trois étapes d'ac_hash, puis ac_hash complet ;
+//   - simple_hash, sha256 : les autres modes de hachage ;
+//   - serialize_* : préimage d'un bloc (stringstream d'origine, BlockHeader
+//     texte et binaire, réécriture du nonce seul) ;
+//   - digest_* : comparaisons (égalité, meets_target, Hamming) et hexadécimal.
+// Balayage : tailles d'entrée x règles x générations (options ci-dessous).
+//
+// Chaque mesure : échauffement, puis calibrage du nombre d'appels par
+// répétition (au moins BENCH_MIN_BATCH_NS), puis --reps répétitions ; on
+// garde le temps par appel de chaque répétition, d'où la médiane et le p99.
+// Sous Linux, les compteurs matériels (cycles, instructions, défauts de cache,
+// mauvaises prédictions de branchement) sont lus par perf_event_open autour
+// de chaque répétition, en mode utilisateur seulement (accepté avec
+// perf_event_paranoid <= 2). Sans accès aux compteurs (conteneur, autre OS),
+// les champs correspondants valent null dans le JSON.
+//
+// Compilation : g++ -O2 -std=c++17 bench_kernels.cpp -o bench_kernels
+// Usage : bench_kernels [--sizes 32,64,256,1024,4096] [--rules 30,90,110]
+//                       [--steps 20,128,512] [--reps 31] [--json bench_kernels.json]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ac_engine.h"
+#include "ac_rng.h"
+#include "block_header.h"
+#include "digest.h"
+#include "sha256.h"
+#include "simple_hash.h"
+#include "target.h"
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+const double BENCH_MIN_BATCH_NS = 200e3; // durée minimale d'une répétition
+const double BENCH_WARMUP_NS = 20e6;
+
+// Empêche le compilateur d'éliminer un calcul dont le résultat est inutilisé
+template <class T>
+inline void keep(const T& v) {
+    asm volatile("" : : "r,m"(v) : "memory");
+}
+
+// ===========================================================
+// ============ COMPTEURS MATÉRIELS (perf_event) =============
+// ===========================================================
+
+enum PerfEvent { PERF_CYCLES, PERF_INSTRUCTIONS, PERF_CACHE_MISSES, PERF_BRANCH_MISSES, PERF_COUNT };
+const char* PERF_NAMES[PERF_COUNT] = {"cycles", "instructions", "cache_misses", "branch_misses"};
+
+// Un groupe : les compteurs démarrent et s'arrêtent ensemble. Un compteur
+// refusé par le noyau (absent de la machine virtuelle...) est simplement
+// ignoré ; si le premier (cycles) est refusé, aucun n'est lu.
+class PerfGroup {
+public:
+    PerfGroup() {
+        std::fill(fd_, fd_ + PERF_COUNT, -1);
+#ifdef __linux__
+        const uint64_t configs[PERF_COUNT] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                              PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for (int e = 0; e < PERF_COUNT; ++e) {
+            if (e > 0 && fd_[0] < 0) break;
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[e];
+            attr.disabled = e == 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+            fd_[e] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, e == 0 ? -1 : fd_[0], 0);
+            if (fd_[e] >= 0) ioctl(fd_[e], PERF_EVENT_IOC_ID, &id_[e]);
+        }
+#endif
+    }
+    ~PerfGroup() {
+#ifdef __linux__
+        for (int fd : fd_)
+            if (fd >= 0) close(fd);
+#endif
+    }
+    PerfGroup(const PerfGroup&) = delete;
+    PerfGroup& operator=(const PerfGroup&) = delete;
+
+    bool available() const { return fd_[0] >= 0; }
+    bool has(int e) const { return fd_[e] >= 0; }
+
+    void start() {
+#ifdef __linux__
+        if (!available()) return;
+        ioctl(fd_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fd_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    // Ajoute les valeurs du groupe à total[]
+    void stop(uint64_t total[PERF_COUNT]) {
+#ifdef __linux__
+        if (!available()) return;
+        ioctl(fd_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        // format : nr, puis (valeur, id) pour chaque compteur du groupe
+        uint64_t buf[1 + 2 * PERF_COUNT];
+        if (read(fd_[0], buf, sizeof(buf)) < (ssize_t)sizeof(uint64_t)) return;
+        for (uint64_t k = 0; k < buf[0] && k < PERF_COUNT; ++k)
+            for (int e = 0; e < PERF_COUNT; ++e)
+                if (fd_[e] >= 0 && id_[e] == buf[2 + 2 * k]) total[e] += buf[1 + 2 * k];
+#else
+        (void)total;
+#endif
+    }
+
+private:
+    int fd_[PERF_COUNT];
+    uint64_t id_[PERF_COUNT] = {};
+};
+
+// ===========================================================
+// ===================== MESURE ==============================
+// ===========================================================
+
+struct BenchResult {
+    string stage;
+    string params;          // paires "clé": valeur du JSON, déjà formatées
+    string label;           // les mêmes, pour l'affichage
+    size_t bytes = 0;       // octets traités par appel (0 : sans objet)
+    uint64_t opsPerRep = 0;
+    vector<double> nsPerOp; // une valeur par répétition, triée
+    double counters[PERF_COUNT] = {};
+    bool hasCounter[PERF_COUNT] = {};
+
+    double percentile(double q) const {
+        // rang le plus proche
+        size_t k = (size_t)std::ceil(q * nsPerOp.size());
+        return nsPerOp[std::min(nsPerOp.size(), std::max<size_t>(k, 1)) - 1];
+    }
+    double median() const { return percentile(0.5); }
+};
+
+class Bench {
+public:
+    Bench(size_t reps) : reps_(reps) {}
+
+    // op(i) : un appel de l'étape mesurée (i = numéro d'appel)
+    template <class Op>
+    void run(const string& stage, const string& params, const string& label, size_t bytes, Op op) {
+        typedef chrono::steady_clock clock;
+        // échauffement et calibrage : on double jusqu'à une répétition assez longue
+        uint64_t ops = 1;
+        auto warmStart = clock::now();
+        for (;;) {
+            auto t0 = clock::now();
+            for (uint64_t i = 0; i < ops; ++i) op(i);
+            double ns = chrono::duration<double, nano>(clock::now() - t0).count();
+            double warm = chrono::duration<double, nano>(clock::now() - warmStart).count();
+            if (ns >= BENCH_MIN_BATCH_NS && warm >= BENCH_WARMUP_NS) break;
+            if (ns < BENCH_MIN_BATCH_NS) ops *= 2;
+        }
+
+        BenchResult r;
+        r.stage = stage;
+        r.params = params;
+        r.label = label;
+        r.bytes = bytes;
+        r.opsPerRep = ops;
+        uint64_t total[PERF_COUNT] = {};
+        for (size_t rep = 0; rep < reps_; ++rep) {
+            perf_.start();
+            auto t0 = clock::now();
+            for (uint64_t i = 0; i < ops; ++i) op(i);
+            auto t1 = clock::now();
+            perf_.stop(total);
+            r.nsPerOp.push_back(chrono::duration<double, nano>(t1 - t0).count() / ops);
+        }
+        std::sort(r.nsPerOp.begin(), r.nsPerOp.end());
+        for (int e = 0; e < PERF_COUNT; ++e) {
+            r.hasCounter[e] = perf_.has(e);
+            r.counters[e] = (double)total[e] / ((double)ops * reps_);
+        }
+        print(r);
+        results_.push_back(r);
+    }
+
+    bool counters_available() const { return perf_.available(); }
+    const vector<BenchResult>& results() const { return results_; }
+
+    static void print_header() {
+        cout << left << setw(26) << "Stage" << setw(30) << "Parameters" << right << setw(12)
+             << "Median ns" << setw(12) << "p99 ns" << setw(10) << "MB/s" << setw(12) << "Cycles"
+             << setw(12) << "Instr" << setw(10) << "LLC miss" << "\n";
+        cout << string(124, '-') << "\n";
+    }
+
+private:
+    static void print(const BenchResult& r) {
+        cout << left << setw(26) << r.stage << setw(30) << r.label << right << fixed
+             << setprecision(1) << setw(12) << r.median() << setw(12) << r.percentile(0.99);
+        if (r.bytes) cout << setw(10) << r.bytes * 1e3 / r.median();
+        else cout << setw(10) << "-";
+        for (int e : {PERF_CYCLES, PERF_INSTRUCTIONS, PERF_CACHE_MISSES}) {
+            int w = e == PERF_CACHE_MISSES ? 10 : 12;
+            if (r.hasCounter[e]) cout << setw(w) << setprecision(e == PERF_CACHE_MISSES ? 2 : 0) << r.counters[e];
+            else cout << setw(w) << "-";
+        }
+        cout << "\n";
+    }
+
+    size_t reps_;
+    PerfGroup perf_;
+    vector<BenchResult> results_;
+};
+
+// ===========================================================
+// ===================== SORTIE JSON =========================
+// ===========================================================
+
+bool write_json(const string& path, const Bench& bench, size_t reps) {
+    ofstream out(path);
+    if (!out) return false;
+    out << setprecision(6);
+    out << "{\n  \"meta\": {\n"
+        << "    \"compiler\": \"" << __VERSION__ << "\",\n"
+        << "    \"kernel_isa\": \"" << kernel_isa_name(best_kernel_isa()) << "\",\n"
+        << "    \"sha256_impl\": \"" << sha256_impl_name(sha256_batch_impl()) << "\",\n"
+        << "    \"reps\": " << reps << ",\n"
+        << "    \"perf_counters\": " << (bench.counters_available() ? "true" : "false") << "\n"
+        << "  },\n  \"results\": [\n";
+    const vector<BenchResult>& rs = bench.results();
+    for (size_t i = 0; i < rs.size(); ++i) {
+        const BenchResult& r = rs[i];
+        out << "    {\"stage\": \"" << r.stage << "\"";
+        if (!r.params.empty()) out << ", " << r.params;
+        out << ", \"ops_per_rep\": " << r.opsPerRep << ", \"median_ns\": " << r.median()
+            << ", \"p99_ns\": " << r.percentile(0.99) << ", \"min_ns\": " << r.nsPerOp.front()
+            << ", \"max_ns\": " << r.nsPerOp.back();
+        if (r.bytes) out << ", \"mb_per_s\": " << r.bytes * 1e3 / r.median();
+        for (int e = 0; e < PERF_COUNT; ++e) {
+            out << ", \"" << PERF_NAMES[e] << "_per_op\": ";
+            if (r.hasCounter[e]) out << r.counters[e];
+            else out << "null";
+        }
+        out << "}" << (i + 1 < rs.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return (bool)out;
+}
+
+// ===========================================================
+// ======================= MAIN ==============================
+// ===========================================================
+
+vector<size_t> parse_list(const string& s) {
+    vector<size_t> out;
+    stringstream ss(s);
+    for (string item; getline(ss, item, ',');)
+        if (!item.empty()) out.push_back(stoull(item));
+    return out;
+}
+
+string json_params(size_t bytes, long rule = -1, long steps = -1, const char* isa = nullptr) {
+    ostringstream p;
+    p << "\"bytes\": " << bytes;
+    if (rule >= 0) p << ", \"rule\": " << rule;
+    if (steps >= 0) p << ", \"steps\": " << steps;
+    if (isa) p << ", \"isa\": \"" << isa << "\"";
+    return p.str();
+}
+
+string text_params(size_t bytes, long rule = -1, long steps = -1, const char* isa = nullptr) {
+    ostringstream p;
+    p << bytes << "B";
+    if (rule >= 0) p << " r" << rule;
+    if (steps >= 0) p << " s" << steps;
+    if (isa) p << " " << isa;
+    return p.str();
+}
+
+int main(int argc, char** argv) {
+    vector<size_t> sizes = {32, 64, 256, 1024, 4096};
+    vector<size_t> rules = {30, 90, 110};
+    vector<size_t> stepsList = {20, 128, 512};
+    size_t reps = 31;
+    string jsonPath = "bench_kernels.json";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string key = argv[i], value = argv[i + 1];
+        if (key == "--sizes") sizes = parse_list(value);
+        else if (key == "--rules") rules = parse_list(value);
+        else if (key == "--steps") stepsList = parse_list(value);
+        else if (key == "--reps") reps = max<size_t>(1, stoull(value));
+        else if (key == "--json") jsonPath = value;
+        else {
+            cerr << "Unknown option " << key << "\n";
+            return 1;
+        }
+    }
+
+    Bench bench(reps);
+    cout << "=== Hashing kernel microbenchmarks ===\n"
+         << "Kernel ISA: " << kernel_isa_name(best_kernel_isa())
+         << ", SHA-256: " << sha256_impl_name(sha256_batch_impl())
+         << ", hardware counters: " << (bench.counters_available() ? "yes" : "unavailable")
+         << ", " << reps << " repetitions\n\n";
+    Bench::print_header();
+
+    Rule30Rng rng(1);
+    for (size_t bytes : sizes) {
+        vector<char> msg(bytes);
+        for (char& c : msg) c = (char)rng();
+        // l'automate des exercices : un int par cellule, bit de poids fort d'abord
+        vector<int> cells(8 * bytes);
+        for (size_t i = 0; i < cells.size(); ++i) cells[i] = (msg[i / 8] >> (7 - i % 8)) & 1;
+        PackedState packed = pack_bytes(msg.data(), bytes);
+
+        bench.run("pack", json_params(bytes), text_params(bytes), bytes,
+                  [&](uint64_t) { keep(pack_bytes(msg.data(), bytes).buf[1]); });
+        bench.run("digest", json_params(bytes), text_params(bytes), bytes,
+                  [&](uint64_t) { keep(packed_to_digest(packed, 256)); });
+
+        for (size_t rule : rules) {
+            for (size_t steps : stepsList) {
+                string jp = json_params(bytes, rule, steps), tp = text_params(bytes, rule, steps);
+                bench.run("evolve_reference", jp, tp, bytes, [&](uint64_t) {
+                    vector<int> s = cells;
+                    for (size_t g = 0; g < steps; ++g) s = evolve(s, (uint32_t)rule);
+                    keep(s[0]);
+                });
+                PackedState work = packed;
+                bench.run("evolve_packed", json_params(bytes, rule, steps, "auto"),
+                          text_params(bytes, rule, steps, "auto"), bytes, [&](uint64_t) {
+                              std::copy(packed.buf.begin(), packed.buf.end(), work.buf.begin());
+                              evolve_packed(work, (uint32_t)rule, steps);
+                              keep(work.buf[1]);
+                          });
+                bench.run("evolve_packed", json_params(bytes, rule, steps, "scalar"),
+                          text_params(bytes, rule, steps, "scalar"), bytes, [&](uint64_t) {
+                              std::copy(packed.buf.begin(), packed.buf.end(), work.buf.begin());
+                              evolve_packed_generic(work, (uint32_t)rule, steps, ZERO_BOUNDARY, ISA_SCALAR);
+                              keep(work.buf[1]);
+                          });
+                bench.run("ac_hash", jp, tp, bytes, [&](uint64_t) {
+                    PackedState s = pack_bytes(msg.data(), bytes);
+                    evolve_packed(s, (uint32_t)rule, steps);
+                    keep(packed_to_digest(s, 256));
+                });
+            }
+        }
+
+        bench.run("simple_hash", json_params(bytes), text_params(bytes), bytes, [&](uint64_t) {
+            keep(simple_hash_digest(simple_hash_update(0, msg.data(), bytes)));
+        });
+        bench.run("sha256", json_params(bytes), text_params(bytes), bytes,
+                  [&](uint64_t) { keep(sha256_digest(msg.data(), bytes)); });
+
+        // préimage d'un bloc : data de `bytes` octets, hash précédent hexadécimal
+        string data(msg.begin(), msg.end());
+        string previousHash(64, '0');
+        bench.run("serialize_stringstream", json_params(bytes), text_params(bytes), bytes,
+                  [&](uint64_t i) {
+                      stringstream ss;
+                      ss << 7 << previousHash << 1700000000L << data << (int64_t)i;
+                      keep(ss.str().size());
+                  });
+        bench.run("serialize_text", json_params(bytes), text_params(bytes), bytes, [&](uint64_t i) {
+            BlockHeader h(TEXT_PREIMAGE, 7, previousHash, 1700000000L, data);
+            h.set_nonce((int64_t)i);
+            keep(h.size());
+        });
+        bench.run("serialize_binary", json_params(bytes), text_params(bytes), bytes, [&](uint64_t i) {
+            BlockHeader h(BINARY_PREIMAGE, 7, previousHash, 1700000000L, data);
+            h.set_nonce((int64_t)i);
+            keep(h.size());
+        });
+        BlockHeader header(TEXT_PREIMAGE, 7, previousHash, 1700000000L, data);
+        bench.run("serialize_set_nonce", json_params(bytes), text_params(bytes), 0, [&](uint64_t i) {
+            header.set_nonce((int64_t)i);
+            keep(header.size());
+        });
+    }
+
+    // comparaisons de digests : indépendantes de la taille d'entrée
+    vector<Digest> digests(1024);
+    for (Digest& d : digests)
+        for (uint8_t& b : d) b = (uint8_t)rng();
+    Target target = target_from_hex_digits(4);
+    auto digestOp = [&](uint64_t i) -> const Digest& { return digests[i & 1023]; };
+    bench.run("digest_equal", "", "", 0,
+              [&](uint64_t i) { keep(digestOp(i) == digestOp(i + 1)); });
+    bench.run("digest_meets_target", "", "", 0,
+              [&](uint64_t i) { keep(meets_target(digestOp(i), target)); });
+    bench.run("digest_hamming", "", "", 0,
+              [&](uint64_t i) { keep(digest_hamming(digestOp(i), digestOp(i + 1))); });
+    bench.run("digest_hex", "", "", 0, [&](uint64_t i) { keep(digest_hex(digestOp(i)).size()); });
+
+    if (!write_json(jsonPath, bench, reps)) {
+        cerr << "Could not write " << jsonPath << "\n";
+        return 1;
+    }
+    cout << "\nResults written to " << jsonPath << "\n";
+    return 0;
+}
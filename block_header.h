@@ -0,0 +1,98 @@
+// block_header.h
+// Préimage d'un bloc (ce que l'on hache) écrite dans un tampon réutilisable.
+//
+// Le stringstream `ss << index << previousHash << timestamp << data << nonce`
+// coûte un formatage dépendant de la locale et plusieurs allocations par
+// nonce testé. Ici les champs fixes sont écrits une seule fois, et le nonce
+// est réécrit sur place à la fin du tampon (offset nonce_offset()), sans
+// allocation. Deux formats :
+//   - TEXT_PREIMAGE   : exactement la chaîne du stringstream d'origine
+//                       (compatibilité : les chaînes existantes restent
+//                       valides) ; le nonce en décimal, de longueur variable.
+//   - BINARY_PREIMAGE : disposition binaire fixe, petit-boutiste :
+//                         [0,4)    index            (int32)
+//                         [4,12)   timestamp        (int64)
+//                         [12,16)  |previousHash|   (uint32), puis ses octets
+//                         +4       |data|           (uint32), puis ses octets
+//                         +8       nonce            (int64), toujours en fin
+// Le nonce reste le dernier champ dans les deux formats : les optimisations
+// du minage AC (ac_incremental.h, ac_bitslice.h) reposent sur un préfixe fixe.
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "miner.h"
+
+enum PreimageFormat { TEXT_PREIMAGE, BINARY_PREIMAGE };
+
+const size_t BINARY_NONCE_BYTES = 8;
+
+inline void put_le(char* out, uint64_t v, size_t bytes) {
+    for (size_t k = 0; k < bytes; ++k)
+        out[k] = (char)(v >> (8 * k));
+}
+
+inline size_t binary_nonce(int64_t nonce, char* out) {
+    put_le(out, (uint64_t)nonce, BINARY_NONCE_BYTES);
+    return BINARY_NONCE_BYTES;
+}
+
+inline NonceEncoder nonce_encoder(PreimageFormat format) {
+    return format == BINARY_PREIMAGE ? binary_nonce : decimal_nonce;
+}
+
+class BlockHeader {
+public:
+    BlockHeader(PreimageFormat format, int index, const std::string& previousHash,
+                long timestamp, const std::string& data)
+        : encode_(nonce_encoder(format)) {
+        if (format == BINARY_PREIMAGE) {
+            put_int(index, 4);
+            put_int(timestamp, 8);
+            put_int(previousHash.size(), 4);
+            buf_.insert(buf_.end(), previousHash.begin(), previousHash.end());
+            put_int(data.size(), 4);
+            buf_.insert(buf_.end(), data.begin(), data.end());
+        } else {
+            put_decimal(index);
+            buf_.insert(buf_.end(), previousHash.begin(), previousHash.end());
+            put_decimal(timestamp);
+            buf_.insert(buf_.end(), data.begin(), data.end());
+        }
+        prefixSize_ = buf_.size();
+        buf_.resize(prefixSize_ + NONCE_MAX_BYTES);
+        set_nonce(0);
+    }
+
+    // Réécrit le nonce sur place (aucune allocation)
+    void set_nonce(int64_t nonce) {
+        size_ = prefixSize_ + encode_(nonce, buf_.data() + prefixSize_);
+    }
+
+    const char* data() const { return buf_.data(); }
+    size_t size() const { return size_; }
+    size_t nonce_offset() const { return prefixSize_; }
+    NonceEncoder encoder() const { return encode_; }
+
+    std::string str() const { return std::string(buf_.data(), size_); }
+    std::string prefix() const { return std::string(buf_.data(), prefixSize_); }
+
+private:
+    void put_int(int64_t v, size_t bytes) {
+        size_t at = buf_.size();
+        buf_.resize(at + bytes);
+        put_le(buf_.data() + at, (uint64_t)v, bytes);
+    }
+
+    void put_decimal(int64_t v) {
+        char digits[NONCE_MAX_BYTES];
+        buf_.insert(buf_.end(), digits, digits + decimal_nonce(v, digits));
+    }
+
+    std::vector<char> buf_;
+    size_t prefixSize_;
+    size_t size_;
+    NonceEncoder encode_;
+};
@@ -0,0 +1,14 @@
+// cpu_features.h
+// Détection de la plateforme à la compilation, partagée par le moteur AC
+// (ac_engine.h) et SHA-256 (sha256.h) : les noyaux x86 (intrinsèques,
+// attributs target) ne sont compilés que si AC_ENGINE_X86 vaut 1. Le choix
+// du noyau à l'exécution (__builtin_cpu_supports) reste dans chaque en-tête.
+#pragma once
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AC_ENGINE_X86 1
+#define AC_INLINE inline __attribute__((always_inline))
+#else
+#define AC_ENGINE_X86 0
+#define AC_INLINE inline
+#endif
@@ -0,0 +1,163 @@
+// digest.h
+// Empreinte binaire de taille fixe (256 bits) pour les hashes des blocs et
+// des outils d'analyse, à la place des chaînes hexadécimales.
+//
+// Un Digest est un std::array<uint8_t, 32> : octet 0 = les deux premiers
+// chiffres hexadécimaux du hash, bit de poids fort d'abord. Les hashes plus
+// courts (simple hash 32 bits, AC_HASH 64 bits d'exercice4) occupent les
+// premiers octets, le reste est à zéro. Comparaisons et distance de Hamming
+// se font sur 4 mots de 64 bits ; la conversion hexadécimale (vectorisée)
+// n'a lieu qu'à l'affichage et à la lecture.
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+const size_t DIGEST_BYTES = 32;
+const size_t DIGEST_WORDS = 4;
+
+struct Digest : std::array<uint8_t, DIGEST_BYTES> {
+    // mot i (octets 8i..8i+7) en gros-boutiste : l'ordre des mots et des
+    // valeurs est celui de la chaîne hexadécimale
+    uint64_t word(size_t i) const {
+        uint64_t w;
+        std::memcpy(&w, data() + 8 * i, 8);
+        return __builtin_bswap64(w);
+    }
+
+    // mot i tel qu'en mémoire (égalité, XOR, popcount)
+    uint64_t raw_word(size_t i) const {
+        uint64_t w;
+        std::memcpy(&w, data() + 8 * i, 8);
+        return w;
+    }
+
+    bool bit(size_t i) const { return ((*this)[i / 8] >> (7 - i % 8)) & 1; }
+};
+
+inline bool operator==(const Digest& a, const Digest& b) {
+    return ((a.raw_word(0) ^ b.raw_word(0)) | (a.raw_word(1) ^ b.raw_word(1)) |
+            (a.raw_word(2) ^ b.raw_word(2)) | (a.raw_word(3) ^ b.raw_word(3))) == 0;
+}
+
+inline bool operator!=(const Digest& a, const Digest& b) { return !(a == b); }
+
+inline bool digest_is_zero(const Digest& d) {
+    return (d.raw_word(0) | d.raw_word(1) | d.raw_word(2) | d.raw_word(3)) == 0;
+}
+
+// Nombre de bits différents : 4 popcnt
+inline int digest_hamming(const Digest& a, const Digest& b) {
+    int n = 0;
+    for (size_t i = 0; i < DIGEST_WORDS; ++i)
+        n += __builtin_popcountll(a.raw_word(i) ^ b.raw_word(i));
+    return n;
+}
+
+inline int digest_popcount(const Digest& d) {
+    int n = 0;
+    for (size_t i = 0; i < DIGEST_WORDS; ++i)
+        n += __builtin_popcountll(d.raw_word(i));
+    return n;
+}
+
+// Nombre de '0' en tête de la forme hexadécimale
+inline int leading_zero_nibbles(const Digest& d) {
+    for (size_t i = 0; i < DIGEST_WORDS; ++i) {
+        uint64_t w = d.word(i);
+        if (w) return (int)(16 * i) + __builtin_clzll(w) / 4;
+    }
+    return (int)(2 * DIGEST_BYTES);
+}
+
+// ===========================================================
+// ================ CODEC HEXADÉCIMAL ========================
+// ===========================================================
+
+// n octets -> 2n caractères. Par blocs de 16 octets : chaque octet est
+// élargi en un mot de 16 bits qui reçoit ses deux chiffres (petit-boutiste :
+// chiffre de poids fort dans l'octet bas), sans table ni branchement.
+inline void hex_encode(const uint8_t* in, size_t n, char* out, bool upper = false) {
+    const uint8_t letter = upper ? 'A' : 'a';
+    size_t i = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    typedef uint8_t u8x16 __attribute__((vector_size(16)));
+    typedef uint16_t u16x16 __attribute__((vector_size(32)));
+    for (; i + 16 <= n; i += 16) {
+        u8x16 b;
+        std::memcpy(&b, in + i, 16);
+        u16x16 w = __builtin_convertvector(b, u16x16);
+        u16x16 hi = w >> 4, lo = w & 15;
+        hi += '0' + ((u16x16)(hi > 9) & (uint16_t)(letter - '0' - 10));
+        lo += '0' + ((u16x16)(lo > 9) & (uint16_t)(letter - '0' - 10));
+        w = hi | (lo << 8);
+        std::memcpy(out + 2 * i, &w, 32);
+    }
+#endif
+    for (char* o = out + 2 * i; i < n; ++i) {
+        uint8_t hi = in[i] >> 4, lo = in[i] & 15;
+        *o++ = (char)(hi < 10 ? '0' + hi : letter + hi - 10);
+        *o++ = (char)(lo < 10 ? '0' + lo : letter + lo - 10);
+    }
+}
+
+// 2n caractères (majuscules ou minuscules) -> n octets. Renvoie false si un
+// caractère n'est pas hexadécimal.
+inline bool hex_decode(const char* in, size_t n, uint8_t* out) {
+    size_t i = 0;
+    bool ok = true;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    typedef uint8_t u8x16 __attribute__((vector_size(16)));
+    typedef uint8_t u8x32 __attribute__((vector_size(32)));
+    typedef uint16_t u16x16 __attribute__((vector_size(32)));
+    u8x32 bad = {};
+    for (; i + 16 <= n; i += 16) {
+        u8x32 c;
+        std::memcpy(&c, in + 2 * i, 32);
+        u8x32 digit = c - '0';
+        u8x32 alpha = (c | 0x20) - 'a';
+        u8x32 isDigit = (u8x32)(digit < 10), isAlpha = (u8x32)(alpha < 6);
+        bad |= ~(isDigit | isAlpha);
+        u8x32 val = (digit & isDigit) | ((alpha + 10) & isAlpha);
+        u16x16 w;
+        std::memcpy(&w, &val, 32);
+        u8x16 b = __builtin_convertvector(((w & 0xFF) << 4) | (w >> 8), u8x16);
+        std::memcpy(out + i, &b, 16);
+    }
+    for (int k = 0; k < 32; ++k) ok &= bad[k] == 0;
+#endif
+    for (const char* p = in + 2 * i; i < n; ++i) {
+        int v[2];
+        for (int k = 0; k < 2; ++k) {
+            char c = *p++;
+            v[k] = (c >= '0' && c <= '9') ? c - '0'
+                 : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+                 : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+            ok &= v[k] >= 0;
+        }
+        out[i] = (uint8_t)((v[0] << 4) | (v[1] & 15));
+    }
+    return ok;
+}
+
+// Les `nibbles` premiers chiffres hexadécimaux du digest
+inline std::string digest_hex(const Digest& d, size_t nibbles = 2 * DIGEST_BYTES,
+                              bool upper = false) {
+    char buf[2 * DIGEST_BYTES];
+    hex_encode(d.data(), DIGEST_BYTES, buf, upper);
+    return std::string(buf, nibbles);
+}
+
+// Lit au plus 64 chiffres hexadécimaux (les suivants sont complétés par des
+// zéros). Renvoie false si la chaîne n'est pas hexadécimale ou trop longue.
+inline bool parse_digest(const std::string& hex, Digest& out) {
+    if (hex.size() > 2 * DIGEST_BYTES) return false;
+    char buf[2 * DIGEST_BYTES];
+    std::memset(buf, '0', sizeof(buf));
+    std::memcpy(buf, hex.data(), hex.size());
+    out = Digest{};
+    return hex_decode(buf, DIGEST_BYTES, out.data());
+}
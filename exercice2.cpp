@@ -3,63 +3,22 @@
 #include <string>
 #include <bitset>
 #include <cstdint>
+#include "ac_engine.h"
 
 using namespace std;
 
-// -------------------- Automate cellulaire --------------------
-int apply_rule(uint32_t rule, int left, int center, int right) {
-    int index = left * 4 + center * 2 + right;
-    return (rule >> index) & 1;  
-}
-
-vector<int> evolve(const vector<int>& state, uint32_t rule) {
-    int n = state.size();
-    vector<int> next_state(n, 0);
-    for (int i = 0; i < n; i++) {
-        int left   = (i == 0) ? 0 : state[i-1];
-        int center = state[i];
-        int right  = (i == n-1) ? 0 : state[i+1];
-        next_state[i] = apply_rule(rule, left, center, right);
-    }
-    return next_state;
-}
-
-// -------------------- Conversion texte -> bits --------------------
-vector<int> text_to_bits(const string& input) {
-    vector<int> bits;
-    for (char c : input) {
-        bitset<8> b(c); // chaque caractère en ASCII → 8 bits
-        for (int i = 7; i >= 0; --i) {
-            bits.push_back(b[i]);
-        }
-    }
-    return bits;
-}
+// Automate cellulaire (apply_rule, evolve, text_to_bits) : voir ac_engine.h
 
 // -------------------- Fonction de hachage AC --------------------
 string ac_hash(const string& input, uint32_t rule, size_t steps) {
-    // 1. Convertir texte en bits
-    vector<int> state = text_to_bits(input);
+    // 1. Convertir texte en bits (état bit-packé, même ordre que text_to_bits)
+    PackedState state = pack_text(input);
 
     // 2. Appliquer l'automate cellulaire pendant `steps` générations
-    for (size_t i = 0; i < steps; ++i) {
-        state = evolve(state, rule);
-    }
-
-    // 3. Produire un hash fixe de 256 bits
-    vector<int> hash_bits(256, 0);
-    for (size_t i = 0; i < 256; ++i) {
-        hash_bits[i] = state[i % state.size()]; // "mélange circulaire"
-    }
-
-    // 4. Convertir en string hexadécimale
-    string hash_str = "";
-    for (size_t i = 0; i < 256; i += 4) {
-        int val = hash_bits[i]*8 + hash_bits[i+1]*4 + hash_bits[i+2]*2 + hash_bits[i+3];
-        hash_str += "0123456789ABCDEF"[val];
-    }
+    evolve_packed(state, rule, steps, ZERO_BOUNDARY);
 
-    return hash_str;
+    // 3. et 4. Hash fixe de 256 bits ("mélange circulaire") en hexadécimal
+    return packed_to_hex(state, 256);
 }
 
 // -------------------- 2.4.un test que deux entrées différentes --------------------
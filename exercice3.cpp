@@ -6,112 +6,165 @@
 #include <bitset>
 #include <cstdint>
 #include <ctime>
+#include <chrono>
+#include <numeric>
+#include <optional>
+#include "ac_engine.h"
+#include "ac2d.h"
+#include "digest.h"
+#include "ac_bitslice.h"
+#include "ac_incremental.h"
+#include "block_header.h"
+#include "miner.h"
+#include "sha256.h"
+#include "simple_hash.h"
+#include "target.h"
 using namespace std;
 
 // ===========================================================
 // ============ PARTIE 2 : FONCTION AC_HASH ==================
 // ===========================================================
 
-int apply_rule(uint32_t rule, int left, int center, int right) {
-    int index = left * 4 + center * 2 + right;
-    return (rule >> index) & 1;
-}
+// apply_rule, evolve, text_to_bits : voir ac_engine.h
 
-vector<int> evolve(const vector<int>& state, uint32_t rule) {
-    int n = state.size();
-    vector<int> next_state(n, 0);
-    for (int i = 0; i < n; i++) {
-        int left   = (i == 0) ? 0 : state[i-1];
-        int center = state[i];
-        int right  = (i == n-1) ? 0 : state[i+1];
-        next_state[i] = apply_rule(rule, left, center, right);
-    }
-    return next_state;
+// hache directement un tampon d'octets (préimage d'un bloc)
+Digest ac_hash_bytes(const char* input, size_t len, uint32_t rule = 30, size_t steps = 100) {
+    PackedState state = pack_bytes(input, len);
+    evolve_packed(state, rule, steps, ZERO_BOUNDARY);
+    return packed_to_digest(state, 256);
 }
 
-vector<int> text_to_bits(const string& input) {
-    vector<int> bits;
-    for (char c : input) {
-        bitset<8> b(c);
-        for (int i = 7; i >= 0; --i)
-            bits.push_back(b[i]);
-    }
-    return bits;
-}
-
-string ac_hash(const string& input, uint32_t rule = 30, size_t steps = 100) {
-    vector<int> state = text_to_bits(input);
-    for (size_t i = 0; i < steps; ++i)
-        state = evolve(state, rule);
-
-    vector<int> hash_bits(256, 0);
-    for (size_t i = 0; i < 256; ++i)
-        hash_bits[i] = state[i % state.size()];
-
-    string hash_str = "";
-    for (size_t i = 0; i < 256; i += 4) {
-        int val = hash_bits[i]*8 + hash_bits[i+1]*4 + hash_bits[i+2]*2 + hash_bits[i+3];
-        hash_str += "0123456789ABCDEF"[val];
-    }
-
-    return hash_str;
+Digest ac_hash(const string& input, uint32_t rule = 30, size_t steps = 100) {
+    return ac_hash_bytes(input.data(), input.size(), rule, steps);
 }
 
 // ===========================================================
 // ============  SHA256  ======
 // ===========================================================
 
-string simpleHash(const string &data) {
-    unsigned int hash = 0;
-    for (char c : data)
-        hash = (hash * 101 + c) % 1000000007; 
-    stringstream ss;
-    ss << hex << setw(8) << setfill('0') << hash;
-    return ss.str();
+// SHA256_MODE : vrai SHA-256 (sha256.h). simpleHash, l'ancien polynôme
+// 32 bits, reste disponible en SIMPLE_HASH_MODE.
+
+// hash = (hash * 101 + c) % 1000000007 : voir simple_hash.h
+Digest simpleHash(const char* data, size_t len) {
+    return simple_hash_digest(simple_hash_update(0, data, len));
+}
+
+Digest simpleHash(const string &data) {
+    return simpleHash(data.data(), data.size());
 }
 
 // ===========================================================
 // ============ PARTIE 3 : INTÉGRATION BLOCKCHAIN ============
 // ===========================================================
 
-enum HashMode { SHA256_MODE, AC_HASH_MODE };
+// AC2D_MODE : automate sur un tore 2D (ac2d.h)
+enum HashMode { SHA256_MODE, AC_HASH_MODE, SIMPLE_HASH_MODE, AC2D_MODE };
 
 // ---- Classe Block ----
 class Block {
 public:
     int index;
-    string previousHash;
+    Digest previousHash; // digest nul : pas de bloc précédent (genèse)
     string data;
     long timestamp;
-    int nonce;
-    string hash;
+    int64_t nonce;
+    Digest hash;
     HashMode mode;
+    PreimageFormat format; // TEXT_PREIMAGE : préimage textuelle d'origine
 
-    Block(int idx, string prev, string d, HashMode m)
-        : index(idx), previousHash(prev), data(d), mode(m), nonce(0) {
+    Block(int idx, const Digest& prev, string d, HashMode m, PreimageFormat f = TEXT_PREIMAGE)
+        : index(idx), previousHash(prev), data(d), mode(m), format(f), nonce(0) {
         timestamp = time(nullptr);
         hash = calculateHash();
     }
 
-    string calculateHash() const {
-        stringstream ss;
-        ss << index << previousHash << timestamp << data << nonce;
-        string blockData = ss.str();
+    // Forme textuelle d'un hash, telle qu'affichée et placée dans la
+    // préimage TEXT_PREIMAGE : 64 chiffres (majuscules pour les AC), 8 pour
+    // le hash simple ; le digest nul s'écrit "0" (previousHash de la genèse)
+    static string hashToString(const Digest& d, HashMode mode) {
+        if (digest_is_zero(d)) return "0";
+        if (mode == SIMPLE_HASH_MODE) return digest_hex(d, 8);
+        return digest_hex(d, 64, mode == AC_HASH_MODE || mode == AC2D_MODE);
+    }
+
+    // index, previousHash, timestamp, data puis nonce (voir block_header.h) ;
+    // en binaire, previousHash est copié tel quel (32 octets)
+    BlockHeader header() const {
+        string prev = (format == TEXT_PREIMAGE)
+                    ? hashToString(previousHash, mode)
+                    : string(previousHash.begin(), previousHash.end());
+        BlockHeader h(format, index, prev, timestamp, data);
+        h.set_nonce(nonce);
+        return h;
+    }
 
+    static Digest hashHeader(const BlockHeader& h, HashMode mode) {
         if (mode == SHA256_MODE)
-            return simpleHash(blockData); // version simplifiée
+            return sha256_digest(h.data(), h.size());
+        else if (mode == SIMPLE_HASH_MODE)
+            return simpleHash(h.data(), h.size()); // version simplifiée
+        else if (mode == AC2D_MODE)
+            return ac2d_hash(h.data(), h.size());
         else
-            return ac_hash(blockData, 30, 100);
+            return ac_hash_bytes(h.data(), h.size(), 30, 100);
     }
 
-    void mineBlock(int difficulty) {
-        string target(difficulty, '0');
-        do {
-            nonce++;
-            hash = calculateHash();
-        } while (hash.substr(0, difficulty) != target);
+    Digest calculateHash() const {
+        return hashHeader(header(), mode);
+    }
 
-        cout << "Bloc miné : " << hash << endl;
+    // threads = 0 : un thread par cœur. Le nonce trouvé est le même que
+    // celui de la boucle séquentielle (le plus petit nonce gagnant).
+    // En mode AC_HASH, une sonde ne calcule que les cellules qui donnent les
+    // premiers chiffres du hash, 64 nonces à la fois (ac_bitslice.h), et seul
+    // le cône de lumière du nonce est recalculé pour les candidats retenus
+    // (ac_incremental.h). En mode AC2D, chaque bit de sortie dépend de tout
+    // l'en-tête : pas de sonde, l'en-tête complet est haché à chaque nonce.
+    // Les champs fixes sont sérialisés et hachés une fois ; chaque essai ne
+    // traite que le nonce, quelle que soit la taille de data.
+    // Le hash est valide s'il est inférieur ou égal à la cible (target.h).
+    // Renvoie false si la cible est inatteignable.
+    bool mineBlock(const Target& target, unsigned threads = 0) {
+        BlockHeader header = this->header();
+        // sonde et hacheur AC : mode AC_HASH seulement (chacun fait évoluer
+        // tout le préfixe sur 100 générations) ; le hacheur n'est construit
+        // que si la sonde montre que le nonce peut changer le résultat
+        optional<AcBitslicedProbe> probe;
+        optional<AcNonceHasher> acHasher;
+        if (mode == AC_HASH_MODE) {
+            probe.emplace(header.prefix(), 30, 100, target_zero_bits(target), header.encoder());
+            if (probe->unreachable()) {
+                cout << "Bloc impossible à miner : les " << target_zero_bits(target)
+                     << " premiers bits du hash ne dépendent pas du nonce." << endl;
+                return false;
+            }
+            acHasher.emplace(header.prefix(), 30, 100, header.encoder());
+        }
+        // SHA-256 et hash simple : état du préfixe calculé une fois (midstate)
+        Sha256NonceHasher shaHasher(header.prefix(), header.encoder()); // 8 nonces par lot
+        SimpleHashNonceHasher simpleHasher(header.prefix(), header.encoder());
+
+        HashMode mode = this->mode;
+        nonce = parallel_nonce_search(nonce + 1, threads, [&]() {
+            // état propre à chaque thread
+            return [mode, header, acHasher, probe, shaHasher, simpleHasher,
+                    target](int64_t n) mutable {
+                if (mode == AC2D_MODE) {
+                    header.set_nonce(n);
+                    return meets_target(ac2d_hash(header.data(), header.size()), target);
+                }
+                if (mode == AC_HASH_MODE && !probe->passes(n)) return false;
+                Digest h = (mode == AC_HASH_MODE) ? acHasher->hash(n)
+                         : (mode == SHA256_MODE)  ? shaHasher.hash(n)
+                                                  : simpleHasher.hash(n);
+                return meets_target(h, target);
+            };
+        });
+        hash = calculateHash();
+
+        cout << "Bloc miné : " << hashToString(hash, mode) << endl;
+        return true;
     }
 };
 
@@ -119,25 +172,48 @@ public:
 class Blockchain {
 public:
     vector<Block> chain;
-    int difficulty;
+    Target target;              // cible courante (3 chiffres '0' au départ)
+    double targetBlockTime;     // durée visée par bloc, en secondes
+    size_t retargetWindow;      // blocs entre deux réajustements
+    vector<double> blockTimes;  // durées de minage de la fenêtre en cours
     HashMode mode;
+    PreimageFormat format;
 
-    Blockchain(HashMode m = SHA256_MODE) : mode(m), difficulty(3) {
+    Blockchain(HashMode m = SHA256_MODE, PreimageFormat f = TEXT_PREIMAGE)
+        : target(target_from_hex_digits(3)), targetBlockTime(1.0), retargetWindow(4),
+          mode(m), format(f) {
         chain.push_back(createGenesisBlock());
     }
 
     Block createGenesisBlock() {
-        return Block(0, "0", "Genesis Block", mode);
+        return Block(0, Digest{}, "Genesis Block", mode, format);
     }
 
     Block getLatestBlock() const {
         return chain.back();
     }
 
-    void addBlock(Block newBlock) {
+    // Renvoie false si le bloc n'a pas pu être miné (cible inatteignable) :
+    // il n'est alors pas ajouté à la chaîne
+    bool addBlock(Block newBlock) {
         newBlock.previousHash = getLatestBlock().hash;
-        newBlock.mineBlock(difficulty);
+        newBlock.format = format;
+        auto start = chrono::steady_clock::now();
+        if (!newBlock.mineBlock(target)) return false;
         chain.push_back(newBlock);
+        blockTimes.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        if (blockTimes.size() >= retargetWindow) retarget();
+        return true;
+    }
+
+    // Ajuste la cible pour que les prochains blocs prennent en moyenne
+    // targetBlockTime : blocs trop rapides -> cible plus basse (plus dur)
+    void retarget() {
+        double actual = accumulate(blockTimes.begin(), blockTimes.end(), 0.0);
+        target = retarget_target(target, actual, targetBlockTime * blockTimes.size());
+        blockTimes.clear();
+        cout << "Nouvelle cible : " << digest_hex(target) << " (~"
+             << target_work(target) << " hashes par bloc)" << endl;
     }
 
     bool isChainValid() {
@@ -160,20 +236,29 @@ int main() {
     cout << "Sélectionnez le mode de hachage :\n";
     cout << "1 - SHA256 \n";
     cout << "2 - AC_HASH (automate cellulaire)\n";
+    cout << "3 - Hash simple (polynôme 32 bits)\n";
+    cout << "4 - AC2D (automate cellulaire sur un tore 2D)\n";
     int choix;
     cin >> choix;
 
-    HashMode mode = (choix == 2) ? AC_HASH_MODE : SHA256_MODE;
+    HashMode mode = (choix == 2) ? AC_HASH_MODE
+                  : (choix == 3) ? SIMPLE_HASH_MODE
+                  : (choix == 4) ? AC2D_MODE : SHA256_MODE;
 
     Blockchain myChain(mode);
 
-    cout << "Ajout du bloc 1" << endl;
-    myChain.addBlock(Block(1, myChain.getLatestBlock().hash, "Transaction A -> B", mode));
-
-    cout << "Ajout du bloc 2" << endl;
-    myChain.addBlock(Block(2, myChain.getLatestBlock().hash, "Transaction C -> D", mode));
+    const char* transactions[] = {"Transaction A -> B", "Transaction C -> D"};
+    for (int i = 1; i <= 2; ++i) {
+        cout << "Ajout du bloc " << i << endl;
+        if (!myChain.addBlock(Block(i, myChain.getLatestBlock().hash, transactions[i - 1], mode))) {
+            cerr << "Le bloc " << i << " n'a pas été ajouté : arrêt (chaîne de "
+                 << myChain.chain.size() << " bloc(s))." << endl;
+            return 1;
+        }
+    }
 
-    cout << "\nBlockchain valide ? " << (myChain.isChainValid() ? "Oui " : "Non ") << endl;
+    cout << "\nBlockchain valide ? " << (myChain.isChainValid() ? "Oui " : "Non ")
+         << "(" << myChain.chain.size() << " blocs)" << endl;
 
     return 0;
 }
@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <vector>
@@ -7,115 +11,165 @@
 #include <cstdint>
 #include <ctime>
 #include <chrono>
+#include "ac_engine.h"
+#include "ac_sponge.h"
+#include "ac_tree.h"
+#include "digest.h"
+#include "block_header.h"
+#include "miner.h"
+#include "sha256.h"
+#include "simple_hash.h"
+#include "target.h"
 using namespace std;
 using namespace std::chrono;
 
 // ======================================================================
 // 1. Fonctions utilitaires pour AC_HASH (Automate cellulaire)
 // ======================================================================
-int apply_rule(uint32_t rule, int left, int center, int right) {
-    int index = left * 4 + center * 2 + right;
-    return (rule >> index) & 1;
-}
+// apply_rule, evolve, text_to_bits : voir ac_engine.h
 
-vector<int> evolve(const vector<int>& state, uint32_t rule) {
-    int n = state.size();
-    vector<int> next_state(n, 0);
-    for (int i = 0; i < n; i++) {
-        int left   = (i == 0) ? 0 : state[i-1];
-        int center = state[i];
-        int right  = (i == n-1) ? 0 : state[i+1];
-        next_state[i] = apply_rule(rule, left, center, right);
-    }
-    return next_state;
-}
-
-vector<int> text_to_bits(const string& input) {
-    vector<int> bits;
-    for (char c : input) {
-        bitset<8> b(c);
-        for (int i = 7; i >= 0; --i)
-            bits.push_back(b[i]);
-    }
-    return bits;
-}
-
-string ac_hash(const string& input, uint32_t rule = 30, size_t steps = 5) {
-    vector<int> state = text_to_bits(input);
-    if (state.size() > 512) state.resize(512);
-
-    for (size_t i = 0; i < steps; ++i)
-        state = evolve(state, rule);
-
-    vector<int> hash_bits(64, 0);
-    for (size_t i = 0; i < 64; ++i)
-        hash_bits[i] = state[i % state.size()];
-
-    string hash_str = "";
-    for (size_t i = 0; i < 64; i += 4) {
-        int val = hash_bits[i]*8 + hash_bits[i+1]*4 + hash_bits[i+2]*2 + hash_bits[i+3];
-        hash_str += "0123456789ABCDEF"[val];
-    }
-    return hash_str;
+// Éponge AC (ac_sponge.h) : toute l'entrée est absorbée par blocs de 32
+// octets, steps générations par bloc, en mémoire constante (plus de
+// troncature à 512 bits). 64 bits de hash : les 8 premiers octets du digest.
+Digest ac_hash(const string& input, uint32_t rule = 30, size_t steps = 5) {
+    AcSponge sponge(rule, steps);
+    sponge.update(input);
+    Digest d = sponge.finalize();
+    std::fill(d.begin() + 8, d.end(), 0);
+    return d;
 }
 
 // ======================================================================
-// 2. Simple hash pour le mode SHA256 simulé
+// 2. SHA-256 réel (sha256.h, SHA-NI / AVX2 si disponibles) ; le simple
+//    hash, ancien mode "SHA256 simulé", reste en SIMPLE_HASH_MODE
 // ======================================================================
-string simpleHash(const string &data) {
-    unsigned int hash = 0;
-    for (char c : data)
-        hash = (hash * 101 + c) % 1000000007; 
-    stringstream ss;
-    ss << hex << setw(8) << setfill('0') << hash;
-    return ss.str();
+// hash = (hash * 101 + c) % 1000000007 : voir simple_hash.h
+Digest simpleHash(const string &data) {
+    return simple_hash_digest(simple_hash_update(0, data.data(), data.size()));
 }
 
 // ======================================================================
 // 3. Définition du bloc et blockchain
 // ======================================================================
-enum HashMode { SHA256_MODE, AC_HASH_MODE };
+enum HashMode { SHA256_MODE, AC_HASH_MODE, SIMPLE_HASH_MODE };
+
+const char* hashModeName(HashMode mode) {
+    return mode == SHA256_MODE ? "sha256" : mode == AC_HASH_MODE ? "ac_hash" : "simple";
+}
+
+// AC_HASH d'un nonce à partir de l'éponge qui a déjà absorbé le préfixe ;
+// `scratch` (propre au thread) reprend cet état sans allocation
+Digest acHashNonce(AcSponge& scratch, const AcSponge& prefix, int64_t nonce) {
+    char digits[NONCE_MAX_BYTES];
+    scratch.reset_from(prefix);
+    scratch.update(digits, decimal_nonce(nonce, digits));
+    Digest d = scratch.finalize();
+    std::fill(d.begin() + 8, d.end(), 0);
+    return d;
+}
 
 class Block {
 public:
     int index;
-    string previousHash;
+    Digest previousHash; // digest nul : pas de bloc précédent (genèse)
     string data;
     long timestamp;
-    int nonce;
-    string hash;
+    int64_t nonce;
+    Digest hash;
     HashMode mode;
+    uint32_t rule;       // paramètres d'AC_HASH
+    size_t steps;
 
-    Block(int idx, string prev, string d, HashMode m)
-        : index(idx), previousHash(prev), data(d), mode(m), nonce(0) {
+    Block(int idx, const Digest& prev, string d, HashMode m, uint32_t r = 30, size_t s = 1)
+        : index(idx), previousHash(prev), data(d), mode(m), nonce(0), rule(r), steps(s) {
         timestamp = time(nullptr);
         hash = calculateHash();
     }
 
-    string calculateHash() const {
-        stringstream ss;
-        ss << index << previousHash << timestamp << data << nonce;
-        string blockData = ss.str();
+    // forme textuelle (préimage, affichage) : 64 chiffres en SHA-256, 16 en
+    // AC_HASH, 8 en hash simple ; le digest nul s'écrit "0"
+    static string hashToString(const Digest& d, HashMode mode) {
+        if (digest_is_zero(d)) return "0";
+        if (mode == AC_HASH_MODE) return digest_hex(d, 16, true);
+        return digest_hex(d, mode == SIMPLE_HASH_MODE ? 8 : 64);
+    }
+
+    // index||previousHash||timestamp||data||nonce (voir block_header.h)
+    BlockHeader header() const {
+        BlockHeader h(TEXT_PREIMAGE, index, hashToString(previousHash, mode), timestamp, data);
+        h.set_nonce(nonce);
+        return h;
+    }
+
+    Digest calculateHash() const {
+        string blockData = header().str();
 
         if (mode == SHA256_MODE)
+            return sha256_digest(blockData.data(), blockData.size());
+        else if (mode == SIMPLE_HASH_MODE)
             return simpleHash(blockData);
         else
-            return ac_hash(blockData, 30, 1);
+            return ac_hash(blockData, rule, steps);
+    }
+
+    // Cherche un nonce valide après le nonce courant, sur `threads` threads
+    // (miner.h), en au plus maxTries essais. Le préfixe fixe est traité une
+    // fois par bloc (midstate SHA-256 et hash simple, éponge AC déjà
+    // nourrie) ; chaque essai ne hache que le nonce. Renvoie le nombre
+    // d'essais jusqu'au nonce gagnant, celui de la boucle séquentielle, ou
+    // -1 si la limite est atteinte. `hashed` reçoit le nombre de nonces
+    // réellement hachés par l'ensemble des threads (nonces testés en trop
+    // par les autres threads compris) : c'est lui qui donne le débit.
+    int64_t mineBlock(const Target& target, unsigned threads, int64_t maxTries, int64_t& hashed) {
+        string prefix = header().prefix();
+        Sha256NonceHasher shaHasher(prefix);
+        SimpleHashNonceHasher simpleHasher(prefix);
+        AcSponge acSponge(rule, steps);
+        acSponge.update(prefix);
+
+        // un compteur par thread, chacun sur sa ligne de cache
+        struct alignas(64) TryCount { int64_t n = 0; };
+        vector<TryCount> counts(threads ? threads : default_mining_threads());
+        atomic<size_t> nextWorker(0);
+
+        HashMode mode = this->mode;
+        int64_t first = nonce + 1, limit = first + maxTries;
+        int64_t found = parallel_nonce_search(first, threads, [&]() {
+            int64_t* count = &counts[nextWorker++].n;
+            AcSponge scratch = acSponge; // tampons de l'éponge, alloués une fois par thread
+            return [mode, target, limit, count, shaHasher, simpleHasher, scratch,
+                    &acSponge](int64_t n) mutable {
+                if (n >= limit) return true; // arrêt : aucun nonce valide avant la limite
+                ++*count;
+                Digest h = (mode == SHA256_MODE)      ? shaHasher.hash(n)
+                         : (mode == SIMPLE_HASH_MODE) ? simpleHasher.hash(n)
+                                                      : acHashNonce(scratch, acSponge, n);
+                return meets_target(h, target);
+            };
+        });
+        hashed = 0;
+        for (const TryCount& c : counts) hashed += c.n;
+        nonce = std::min(found, limit - 1);
+        hash = calculateHash();
+        return found < limit ? found - first + 1 : -1;
     }
 };
 
 class Blockchain {
 public:
     vector<Block> chain;
-    int difficulty;
+    Target target; // hash valide si hash <= target (target.h)
     HashMode mode;
+    uint32_t rule;
+    size_t steps;
 
-    Blockchain(HashMode m = SHA256_MODE) : mode(m), difficulty(3) {
+    Blockchain(HashMode m = SHA256_MODE, uint32_t r = 30, size_t s = 1)
+        : target(target_from_hex_digits(3)), mode(m), rule(r), steps(s) {
         chain.push_back(createGenesisBlock());
     }
 
     Block createGenesisBlock() {
-        return Block(0, "0", "Genesis Block", mode);
+        return Block(0, Digest{}, "Genesis Block", mode, rule, steps);
     }
 
     Block getLatestBlock() const {
@@ -124,136 +178,323 @@ public:
 };
 
 // ======================================================================
-// 4. Benchmark avec sécurité contre les boucles infinies
+// 4. Matrice de benchmark : mode x règle x générations x difficulté x
+//    threads x taille des données. Chaque configuration mine une chaîne
+//    de `blocks` blocs (au plus maxTries essais par bloc).
 // ======================================================================
-struct BenchmarkResult {
-    double totalTime;
-    int totalIterations;
-    double avgTimePerBlock;
-    double avgIterationsPerBlock;
+struct MatrixConfig {
+    HashMode mode;
+    uint32_t rule;    // règle et générations : AC_HASH seulement (0 sinon)
+    size_t steps;
+    int difficulty;   // chiffres hexadécimaux '0' en tête (target_from_hex_digits)
+    unsigned threads;
+    size_t payload;   // octets de data par bloc
+};
+
+struct MatrixResult {
+    MatrixConfig cfg;
+    int mined = 0, failed = 0;
+    int64_t totalTries = 0;   // essais jusqu'au nonce gagnant (travail séquentiel)
+    int64_t totalHashes = 0;  // nonces réellement hachés par tous les threads
+    double totalTime = 0;
+    double hashesPerSec = 0;
+    double meanBlockTime = 0, p50BlockTime = 0, p99BlockTime = 0;
+    double meanTries = 0;
+    double scaling = 0; // débit / (débit à 1 thread x threads)
+};
+
+struct MatrixOptions {
+    vector<HashMode> modes = {SHA256_MODE, AC_HASH_MODE, SIMPLE_HASH_MODE};
+    vector<size_t> rules = {30};
+    vector<size_t> steps = {1};
+    vector<size_t> difficulties = {1, 2, 3};
+    vector<size_t> threads = {1, default_mining_threads()};
+    vector<size_t> payloads = {64, 1024};
+    int blocks = 20;
+    int64_t maxTries = 200000; // limite de sécurité par bloc
+    string csv = "mining_matrix.csv";
+    string json = "mining_matrix.json";
+    size_t treeBytes = 16 << 20;
 };
 
-BenchmarkResult benchmarkBlockchain(HashMode mode, int numBlocks, int difficulty) {
-    BenchmarkResult result;
-    result.totalIterations = 0;
-    
-    Blockchain chain(mode);
-    chain.difficulty = difficulty;
-    
-    auto start = high_resolution_clock::now();
-
-    int maxTries = 200000; // Limite de sécurité
-    
+// Rang le plus proche ; v trié
+double percentile(const vector<double>& v, double q) {
+    if (v.empty()) return 0;
+    size_t k = (size_t)ceil(q * v.size());
+    return v[std::min(v.size(), std::max<size_t>(k, 1)) - 1];
+}
+
+// data de exactement `payload` octets, différente pour chaque bloc
+string blockPayload(int i, size_t payload) {
+    string d = "Transaction " + to_string(i) + " ";
+    d.resize(payload, '\0');
+    for (size_t k = 0; k < payload; ++k)
+        if (d[k] == '\0') d[k] = (char)('a' + (k * 7 + i) % 26);
+    return d;
+}
+
+MatrixResult benchmarkConfig(const MatrixConfig& cfg, int numBlocks, int64_t maxTries) {
+    MatrixResult result;
+    result.cfg = cfg;
+    Blockchain chain(cfg.mode, cfg.rule, cfg.steps);
+    chain.target = target_from_hex_digits(cfg.difficulty);
+
+    vector<double> blockTimes;
     for (int i = 1; i <= numBlocks; i++) {
-        Block newBlock(i, chain.getLatestBlock().hash, 
-                       "Transaction " + to_string(i), mode);
-        newBlock.previousHash = chain.getLatestBlock().hash;
-        
-        string target(difficulty, '0');
-        bool mined = false;
-
-        do {
-            newBlock.nonce++;
-            result.totalIterations++;
-            newBlock.hash = newBlock.calculateHash();
-
-            // Critère différent pour AC_HASH (dernier char == '0')
-            if (mode == AC_HASH_MODE)
-                mined = (newBlock.hash.back() == '0');
-            else
-                mined = (newBlock.hash.substr(0, difficulty) == target);
-
-        } while (!mined && newBlock.nonce < maxTries);
-        
+        Block newBlock(i, chain.getLatestBlock().hash, blockPayload(i, cfg.payload), cfg.mode,
+                       cfg.rule, cfg.steps);
+        auto start = steady_clock::now();
+        int64_t hashed = 0;
+        int64_t tries = newBlock.mineBlock(chain.target, cfg.threads, maxTries, hashed);
+        double seconds = duration<double>(steady_clock::now() - start).count();
+        result.totalTime += seconds;
+        result.totalHashes += hashed;
+        result.totalTries += tries < 0 ? maxTries : tries;
+        if (tries < 0) {
+            result.failed++;
+            continue;
+        }
+        result.mined++;
+        blockTimes.push_back(seconds);
         chain.chain.push_back(newBlock);
+    }
 
-        if (mined)
-            cout << "  Block " << i << " mined (nonce: " << newBlock.nonce << ")" << endl;
-        else
-            cout << "  Block " << i << " could not be mined (max tries reached)" << endl;
+    sort(blockTimes.begin(), blockTimes.end());
+    result.hashesPerSec = result.totalTime > 0 ? result.totalHashes / result.totalTime : 0;
+    if (result.mined > 0) {
+        double sum = 0;
+        for (double t : blockTimes) sum += t;
+        result.meanBlockTime = sum / result.mined;
+        result.meanTries = (double)(result.totalTries - (int64_t)result.failed * maxTries) / result.mined;
     }
-    
-    auto end = high_resolution_clock::now();
-    duration<double> elapsed = end - start;
-    
-    result.totalTime = elapsed.count();
-    result.avgTimePerBlock = result.totalTime / numBlocks;
-    result.avgIterationsPerBlock = (double)result.totalIterations / numBlocks;
-    
+    result.p50BlockTime = percentile(blockTimes, 0.50);
+    result.p99BlockTime = percentile(blockTimes, 0.99);
     return result;
 }
 
+bool sameExceptThreads(const MatrixConfig& a, const MatrixConfig& b) {
+    return a.mode == b.mode && a.rule == b.rule && a.steps == b.steps &&
+           a.difficulty == b.difficulty && a.payload == b.payload;
+}
+
+// Efficacité : débit / (débit du plus petit nombre de threads mesuré,
+// ramené à un thread, x threads). 1.0 = accélération linéaire.
+void computeScaling(vector<MatrixResult>& results) {
+    for (MatrixResult& r : results) {
+        const MatrixResult* base = nullptr;
+        for (const MatrixResult& o : results)
+            if (sameExceptThreads(o.cfg, r.cfg) && (!base || o.cfg.threads < base->cfg.threads))
+                base = &o;
+        double perThread = base->hashesPerSec / base->cfg.threads;
+        r.scaling = perThread > 0 ? r.hashesPerSec / (perThread * r.cfg.threads) : 0;
+    }
+}
+
+vector<MatrixConfig> buildMatrix(const MatrixOptions& opt) {
+    vector<MatrixConfig> configs;
+    for (HashMode mode : opt.modes) {
+        // règle et générations n'ont de sens que pour AC_HASH
+        vector<size_t> rules = mode == AC_HASH_MODE ? opt.rules : vector<size_t>{0};
+        vector<size_t> steps = mode == AC_HASH_MODE ? opt.steps : vector<size_t>{0};
+        for (size_t rule : rules)
+            for (size_t s : steps)
+                for (size_t d : opt.difficulties)
+                    for (size_t payload : opt.payloads)
+                        for (size_t t : opt.threads)
+                            configs.push_back({mode, (uint32_t)rule, s, (int)d, (unsigned)t, payload});
+    }
+    return configs;
+}
+
 // ======================================================================
-// 5. Affichage comparatif
+// 5. Affichage et export (CSV, JSON)
 // ======================================================================
-void displayComparisonTable(const BenchmarkResult& sha256Result, 
-                           const BenchmarkResult& acHashResult,
-                           int numBlocks, int difficulty) {
-    cout << "\n+--------------------------------------------+" << endl;
-    cout << "|       COMPARISON TABLE                     |" << endl;
-    cout << "+--------------------------------------------+" << endl;
-    cout << "| Blocks: " << setw(2) << numBlocks << " | Difficulty: " << difficulty << "            |" << endl;
-    cout << "+-------------------------------+---------+-------------+" << endl;
-    cout << "| Metric                        | SHA256  | AC_HASH     |" << endl;
-    cout << "+-------------------------------+---------+-------------+" << endl;
-    
-    cout << fixed << setprecision(4);
-    
-    cout << "| Total time (s)                 | " 
-         << setw(7) << sha256Result.totalTime << " | " 
-         << setw(11) << acHashResult.totalTime << " |" << endl;
-    
-    cout << "| Avg time per block (s)         | " 
-         << setw(7) << sha256Result.avgTimePerBlock << " | " 
-         << setw(11) << acHashResult.avgTimePerBlock << " |" << endl;
-    
-    cout << "+-------------------------------+---------+-------------+" << endl;
-    
-    cout << "| Total iterations               | " 
-         << setw(7) << sha256Result.totalIterations << " | " 
-         << setw(11) << acHashResult.totalIterations << " |" << endl;
-    
-    cout << "| Avg iterations per block       | " 
-         << setw(7) << (int)sha256Result.avgIterationsPerBlock << " | " 
-         << setw(11) << (int)acHashResult.avgIterationsPerBlock << " |" << endl;
-    
-    cout << "+-------------------------------+---------+-------------+" << endl;
-    
-    cout << "\nANALYSIS:" << endl;
-    cout << "AC_HASH is " << setprecision(2) 
-         << (acHashResult.totalTime / sha256Result.totalTime) 
-         << "x slower than SHA256" << endl;
-    cout << "Time difference: " << setprecision(4)
-         << (acHashResult.totalTime - sha256Result.totalTime) 
-         << " seconds" << endl;
-    cout << "AC_HASH requires " << setprecision(2)
-         << (acHashResult.avgIterationsPerBlock / sha256Result.avgIterationsPerBlock)
-         << "x more iterations on average" << endl;
+void displayMatrixHeader() {
+    cout << left << setw(9) << "Mode" << right << setw(5) << "Rule" << setw(6) << "Steps"
+         << setw(5) << "Diff" << setw(8) << "Threads" << setw(8) << "Payload" << setw(7)
+         << "Mined" << setw(12) << "Hashes/s" << setw(11) << "Mean (s)" << setw(11)
+         << "p50 (s)" << setw(11) << "p99 (s)" << setw(9) << "Scaling" << endl;
+    cout << string(102, '-') << endl;
+}
+
+void displayMatrixRow(const MatrixResult& r) {
+    cout << left << setw(9) << hashModeName(r.cfg.mode) << right << setw(5) << r.cfg.rule
+         << setw(6) << r.cfg.steps << setw(5) << r.cfg.difficulty << setw(8) << r.cfg.threads
+         << setw(8) << r.cfg.payload << setw(4) << r.mined << "/" << setw(2)
+         << r.mined + r.failed << fixed << setprecision(0) << setw(12) << r.hashesPerSec
+         << setprecision(5) << setw(11) << r.meanBlockTime << setw(11) << r.p50BlockTime
+         << setw(11) << r.p99BlockTime << setprecision(2) << setw(9) << r.scaling << endl;
+}
+
+bool writeMatrixCsv(const string& path, const vector<MatrixResult>& results) {
+    ofstream out(path);
+    if (!out) return false;
+    out << "mode,rule,steps,difficulty,threads,payload_bytes,blocks_mined,blocks_failed,"
+           "total_tries,total_hashes,total_time_s,hashes_per_sec,mean_tries,mean_block_s,p50_block_s,"
+           "p99_block_s,scaling_efficiency\n";
+    out << setprecision(8);
+    for (const MatrixResult& r : results)
+        out << hashModeName(r.cfg.mode) << "," << r.cfg.rule << "," << r.cfg.steps << ","
+            << r.cfg.difficulty << "," << r.cfg.threads << "," << r.cfg.payload << ","
+            << r.mined << "," << r.failed << "," << r.totalTries << "," << r.totalHashes << ","
+            << r.totalTime << ","
+            << r.hashesPerSec << "," << r.meanTries << "," << r.meanBlockTime << ","
+            << r.p50BlockTime << "," << r.p99BlockTime << "," << r.scaling << "\n";
+    return (bool)out;
+}
+
+bool writeMatrixJson(const string& path, const vector<MatrixResult>& results,
+                     const MatrixOptions& opt) {
+    ofstream out(path);
+    if (!out) return false;
+    out << setprecision(8);
+    out << "{\n  \"blocks_per_config\": " << opt.blocks << ",\n  \"max_tries\": " << opt.maxTries
+        << ",\n  \"hardware_threads\": " << default_mining_threads() << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const MatrixResult& r = results[i];
+        out << "    {\"mode\": \"" << hashModeName(r.cfg.mode) << "\", \"rule\": " << r.cfg.rule
+            << ", \"steps\": " << r.cfg.steps << ", \"difficulty\": " << r.cfg.difficulty
+            << ", \"threads\": " << r.cfg.threads << ", \"payload_bytes\": " << r.cfg.payload
+            << ", \"blocks_mined\": " << r.mined << ", \"blocks_failed\": " << r.failed
+            << ", \"total_tries\": " << r.totalTries << ", \"total_hashes\": " << r.totalHashes
+            << ", \"total_time_s\": " << r.totalTime
+            << ", \"hashes_per_sec\": " << r.hashesPerSec << ", \"mean_tries\": " << r.meanTries
+            << ", \"block_time_s\": {\"mean\": " << r.meanBlockTime << ", \"p50\": "
+            << r.p50BlockTime << ", \"p99\": " << r.p99BlockTime << "}"
+            << ", \"scaling_efficiency\": " << r.scaling << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return (bool)out;
 }
 
 // ======================================================================
-// 6. main()
+// 6. Gros payload : mode arbre (ac_tree.h), 1 thread contre tous les cœurs
 // ======================================================================
-int main() {
-    int numBlocks = 10;
-    int difficulty = 1;
-    
+void benchmarkPayloadHashing(size_t bytes) {
+    string payload(bytes, '\0');
+    for (size_t i = 0; i < bytes; ++i) payload[i] = (char)(i * 2654435761u >> 24);
+
+    unsigned cores = default_mining_threads();
+    double seconds[2];
+    Digest digests[2];
+    unsigned threads[2] = {1, cores};
+    for (int k = 0; k < 2; ++k) {
+        auto start = high_resolution_clock::now();
+        digests[k] = ac_tree_hash(payload, 30, 8, threads[k]);
+        seconds[k] = duration<double>(high_resolution_clock::now() - start).count();
+    }
+
+    double mb = bytes / 1e6;
+    cout << fixed << setprecision(1);
+    cout << "  " << mb << " MB, 1 thread : " << mb / seconds[0] << " MB/s" << endl;
+    cout << "  " << mb << " MB, " << cores << " threads: " << mb / seconds[1] << " MB/s" << endl;
+    cout << "  Same digest: " << (digests[0] == digests[1] ? "yes" : "NO")
+         << " (" << digest_hex(digests[0], 16, true) << ")" << endl;
+}
+
+// ======================================================================
+// 7. main()
+// Usage : exercice4 [--modes sha256,ac_hash,simple] [--rules 30] [--steps 1]
+//                   [--difficulty 1,2,3] [--threads 1,N] [--payload 64,1024]
+//                   [--blocks 20] [--max-tries 200000] [--csv mining_matrix.csv]
+//                   [--json mining_matrix.json] [--tree-mb 16]
+// ======================================================================
+vector<string> splitList(const string& s) {
+    vector<string> out;
+    stringstream ss(s);
+    for (string item; getline(ss, item, ',');)
+        if (!item.empty()) out.push_back(item);
+    return out;
+}
+
+vector<size_t> parseNumbers(const string& s) {
+    vector<size_t> out;
+    for (const string& item : splitList(s)) out.push_back(stoull(item));
+    return out;
+}
+
+bool parseOptions(int argc, char** argv, MatrixOptions& opt) {
+    if ((argc - 1) % 2) {
+        cerr << "Missing value for " << argv[argc - 1] << endl;
+        return false;
+    }
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string key = argv[i], value = argv[i + 1];
+        if (key == "--modes") {
+            opt.modes.clear();
+            for (const string& m : splitList(value)) {
+                if (m == "sha256") opt.modes.push_back(SHA256_MODE);
+                else if (m == "ac_hash" || m == "ac") opt.modes.push_back(AC_HASH_MODE);
+                else if (m == "simple") opt.modes.push_back(SIMPLE_HASH_MODE);
+                else {
+                    cerr << "Unknown hash mode " << m << endl;
+                    return false;
+                }
+            }
+        } else if (key == "--rules") opt.rules = parseNumbers(value);
+        else if (key == "--steps") opt.steps = parseNumbers(value);
+        else if (key == "--difficulty") opt.difficulties = parseNumbers(value);
+        else if (key == "--threads") opt.threads = parseNumbers(value);
+        else if (key == "--payload") opt.payloads = parseNumbers(value);
+        else if (key == "--blocks") opt.blocks = max(1, stoi(value));
+        else if (key == "--max-tries") opt.maxTries = max<int64_t>(1, stoll(value));
+        else if (key == "--csv") opt.csv = value;
+        else if (key == "--json") opt.json = value;
+        else if (key == "--tree-mb") opt.treeBytes = stoull(value) << 20;
+        else {
+            cerr << "Unknown option " << key << endl;
+            return false;
+        }
+    }
+    // 0 thread : un par cœur ; doublons retirés (machine à un cœur)
+    for (size_t& t : opt.threads)
+        if (t == 0) t = default_mining_threads();
+    sort(opt.threads.begin(), opt.threads.end());
+    opt.threads.erase(unique(opt.threads.begin(), opt.threads.end()), opt.threads.end());
+    return true;
+}
+
+int main(int argc, char** argv) {
+    MatrixOptions opt;
+    if (!parseOptions(argc, argv, opt)) return 1;
+    vector<MatrixConfig> configs = buildMatrix(opt);
+
     cout << "Configuration:" << endl;
-    cout << "  - Number of blocks: " << numBlocks << endl;
-    cout << "  - Difficulty: " << difficulty << " (prefix of zeros required)" << endl;
+    cout << "  - Configurations: " << configs.size() << ", " << opt.blocks
+         << " blocks each (max " << opt.maxTries << " tries per block)" << endl;
+    cout << "  - Difficulty: prefix of zeros required (hex digits)" << endl;
+    cout << "  - Hardware threads: " << default_mining_threads() << endl;
+    cout << "  - SHA-256: " << sha256_impl_name(cpu_supports_sha256(SHA256_SHANI) ? SHA256_SHANI
+                                                                                : SHA256_PORTABLE)
+         << endl;
     cout << "\n----------------------------------------------\n" << endl;
-    
-    cout << "TEST 1: Mining with SHA256" << endl;
-    cout << "----------------------------------------------" << endl;
-    BenchmarkResult sha256Result = benchmarkBlockchain(SHA256_MODE, numBlocks, difficulty);
-    cout << "Done in " << fixed << setprecision(4) << sha256Result.totalTime << " seconds\n" << endl;
-    
-    cout << "TEST 2: Mining with AC_HASH" << endl;
+
+    cout << "TEST 1: Mining benchmark matrix" << endl;
     cout << "----------------------------------------------" << endl;
-    BenchmarkResult acHashResult = benchmarkBlockchain(AC_HASH_MODE, numBlocks, difficulty);
-    cout << "Done in " << fixed << setprecision(4) << acHashResult.totalTime << " seconds\n" << endl;
-    
-    displayComparisonTable(sha256Result, acHashResult, numBlocks, difficulty);
+    vector<MatrixResult> results;
+    for (size_t i = 0; i < configs.size(); ++i) {
+        results.push_back(benchmarkConfig(configs[i], opt.blocks, opt.maxTries));
+        cout << "  [" << i + 1 << "/" << configs.size() << "] " << hashModeName(configs[i].mode)
+             << ", difficulty " << configs[i].difficulty << ", " << configs[i].threads
+             << " thread(s), " << configs[i].payload << " bytes: done in " << fixed
+             << setprecision(3) << results.back().totalTime << " s" << endl;
+    }
+    computeScaling(results);
+
+    cout << "\nScaling: throughput / (throughput at the fewest threads, per thread, x threads)" << endl;
+    displayMatrixHeader();
+    for (const MatrixResult& r : results) displayMatrixRow(r);
+
+    if (!writeMatrixCsv(opt.csv, results)) cerr << "Could not write " << opt.csv << endl;
+    if (!writeMatrixJson(opt.json, results, opt)) cerr << "Could not write " << opt.json << endl;
+    cout << "\nResults written to " << opt.csv << " and " << opt.json << endl;
+
+    if (opt.treeBytes > 0) {
+        cout << "\nTEST 2: AC_HASH tree mode on a large payload" << endl;
+        cout << "----------------------------------------------" << endl;
+        benchmarkPayloadHashing(opt.treeBytes);
+    }
 
     return 0;
 }
@@ -6,155 +6,244 @@
 #include <bitset>
 #include <cstdint>
 #include <ctime>
+#include <chrono>
+#include <numeric>
+#include <optional>
+#include "ac_engine.h"
+#include "ac2d.h"
+#include "digest.h"
+#include "ac_bitslice.h"
+#include "ac_incremental.h"
+#include "block_header.h"
+#include "miner.h"
+#include "sha256.h"
+#include "simple_hash.h"
+#include "target.h"
 using namespace std;
 
 // ===========================================================
 // ============ AUTOMATE CELLULAIRE : RULEX HASH =============
 // ===========================================================
 
-int apply_rule(uint32_t rule, int left, int center, int right) {
-    int index = left * 4 + center * 2 + right; // binaire -> index
-    return (rule >> index) & 1;
-}
-
-vector<int> evolve(const vector<int>& state, uint32_t rule) {
-    int n = state.size();
-    vector<int> next_state(n, 0);
-    for (int i = 0; i < n; i++) {
-        int left   = (i == 0) ? 0 : state[i-1];
-        int center = state[i];
-        int right  = (i == n-1) ? 0 : state[i+1];
-        next_state[i] = apply_rule(rule, left, center, right);
-    }
-    return next_state;
-}
+// apply_rule, evolve, text_to_bits (version de référence) : voir ac_engine.h
 
-vector<int> text_to_bits(const string& input) {
-    vector<int> bits;
-    for (char c : input) {
-        bitset<8> b(c);
-        for (int i = 7; i >= 0; --i)
-            bits.push_back(b[i]);
-    }
-    return bits;
-}
+// Générations par hash en rayon 1 ; une règle de rayon 2 diffuse deux fois
+// plus vite et n'en fait que la moitié
+const size_t AC_STEPS = 128;
 
-string ac_hash(const string& input, uint32_t rule = 30, size_t steps = 128) {
-    vector<int> state = text_to_bits(input);
+inline size_t ac_steps(int radius) { return AC_STEPS / radius; }
 
-    // évolution répétée
-    for (size_t i = 0; i < steps; ++i)
-        state = evolve(state, rule);
+// hache directement un tampon d'octets (préimage d'un bloc). radius = 2 :
+// voisinage de 5 cellules, `rule` est alors une table de 32 bits
+Digest ac_hash_bytes(const char* input, size_t len, uint32_t rule = 30, size_t steps = 128,
+                     int radius = 1) {
+    PackedState state = pack_bytes(input, len);
 
-    // on prend 256 bits pour produire un hash hex
-    vector<int> hash_bits(256, 0);
-    for (size_t i = 0; i < 256; ++i)
-        hash_bits[i] = state[i % state.size()];
+    // évolution répétée, 64 cellules par mot
+    evolve_packed_radius(state, rule, radius, steps, ZERO_BOUNDARY);
 
-    // conversion 4 bits -> hex
-    string hash_str = "";
-    for (size_t i = 0; i < 256; i += 4) {
-        int val = hash_bits[i]*8 + hash_bits[i+1]*4 +
-                  hash_bits[i+2]*2 + hash_bits[i+3];
-        hash_str += "0123456789ABCDEF"[val];
-    }
+    // on prend 256 bits (state[i % n]) pour produire le hash
+    return packed_to_digest(state, 256);
+}
 
-    return hash_str;
+Digest ac_hash(const string& input, uint32_t rule = 30, size_t steps = 128, int radius = 1) {
+    return ac_hash_bytes(input.data(), input.size(), rule, steps, radius);
 }
 
 // ===========================================================
 // ============ SIMPLE HASH (remplace SHA256) ================
 // ===========================================================
-string simpleHash(const string &data) {
-    unsigned int hash = 0;
-    for (char c : data)
-        hash = (hash * 101 + c) % 1000000007;
-
-    stringstream ss;
-    ss << hex << setw(8) << setfill('0') << hash;
-    return ss.str();
+// hash = (hash * 101 + c) % 1000000007 : voir simple_hash.h
+Digest simpleHash(const char* data, size_t len) {
+    return simple_hash_digest(simple_hash_update(0, data, len));
+}
+
+Digest simpleHash(const string &data) {
+    return simpleHash(data.data(), data.size());
 }
 
 // ===========================================================
 // ==================== BLOCKCHAIN ===========================
 // ===========================================================
 
-enum HashMode { SHA256_MODE, AC_HASH_MODE };
+// SHA256_MODE : vrai SHA-256 (sha256.h) ; SIMPLE_HASH_MODE : simpleHash
+// AC2D_MODE : automate sur un tore 2D (ac2d.h), rule = règle B.../S...
+enum HashMode { SHA256_MODE, AC_HASH_MODE, SIMPLE_HASH_MODE, AC2D_MODE };
 
 class Block {
 public:
     int index;
-    string previousHash;
+    Digest previousHash; // digest nul : pas de bloc precedent (genese)
     string data;
     long timestamp;
-    int nonce;
-    string hash;
+    int64_t nonce;
+    Digest hash;
     HashMode mode;
     uint32_t rule;
+    int radius;            // 1 : règle 0..255 ; 2 : table de 32 bits
+    PreimageFormat format; // TEXT_PREIMAGE : préimage textuelle d'origine
 
-    Block(int idx, string prev, string d, HashMode m, uint32_t r)
-        : index(idx), previousHash(prev), data(d), mode(m), rule(r), nonce(0) {
+    Block(int idx, const Digest& prev, string d, HashMode m, uint32_t r, int rad = 1,
+          PreimageFormat f = TEXT_PREIMAGE)
+        : index(idx), previousHash(prev), data(d), mode(m), rule(r), radius(rad), format(f), nonce(0) {
         timestamp = time(nullptr);
         hash = calculateHash();
     }
 
-    string calculateHash() const {
-        stringstream ss;
-        ss << index << previousHash << timestamp << data << nonce;
-        return ss.str(); // pas de hash ici !
+    // forme affichée et placée dans la préimage texte ; digest nul -> "0"
+    static string hashToString(const Digest& d, HashMode mode) {
+        if (digest_is_zero(d)) return "0";
+        if (mode == SIMPLE_HASH_MODE) return digest_hex(d, 8);
+        return digest_hex(d, 64, mode == AC_HASH_MODE || mode == AC2D_MODE);
     }
 
-    void mineBlock(int difficulty) {
-        string target(difficulty, '0');
-        string blockData;
-        time_t start = clock();
+    // index, previousHash, timestamp, data puis nonce (voir block_header.h) ;
+    // en binaire, previousHash est copié tel quel (32 octets)
+    BlockHeader header() const {
+        string prev = (format == TEXT_PREIMAGE)
+                    ? hashToString(previousHash, mode)
+                    : string(previousHash.begin(), previousHash.end());
+        BlockHeader h(format, index, prev, timestamp, data);
+        h.set_nonce(nonce);
+        return h;
+    }
 
-        do {
-            nonce++;
-            stringstream ss;
-            ss << index << previousHash << timestamp << data << nonce;
-            blockData = ss.str();
+    static Digest hashHeader(const BlockHeader& h, HashMode mode, uint32_t rule, int radius) {
+        if (mode == AC_HASH_MODE)
+            return ac_hash_bytes(h.data(), h.size(), rule, ac_steps(radius), radius);
+        if (mode == AC2D_MODE)
+            return ac2d_hash(h.data(), h.size(), rule);
+        if (mode == SHA256_MODE)
+            return sha256_digest(h.data(), h.size());
+        return simpleHash(h.data(), h.size());
+    }
 
-            if (mode == AC_HASH_MODE)
-                hash = ac_hash(blockData, rule, 128);
-            else
-                hash = simpleHash(blockData);
+    // hash du bloc pour le nonce courant, selon le mode choisi (la genèse
+    // aussi : son hash n'est plus sa préimage brute)
+    Digest calculateHash() const {
+        return hashHeader(header(), mode, rule, radius);
+    }
 
-        } while (hash.substr(0, difficulty) != target);
+    // threads = 0 : un thread par cœur. Chaque thread teste des tranches de
+    // nonces sur sa propre copie du bloc ; le résultat est le plus petit
+    // nonce gagnant, comme avec la boucle nonce++ d'origine. En mode AC_HASH,
+    // une sonde bitslicée rejette d'abord les nonces par lots de 64, à partir
+    // des seules cellules qui donnent les premiers chiffres du hash ; pour
+    // les autres, l'évolution du préfixe fixe est en cache et seul le cône de
+    // lumière du nonce est recalculé (rayon 1 seulement : en rayon 2, chaque
+    // essai hache la préimage complète, de même en AC2D où chaque bit de
+    // sortie dépend de tout l'en-tête). En SHA-256 et hash simple, seul le
+    // nonce est haché après l'état du préfixe (midstate). Le hash est valide
+    // s'il est inférieur ou égal à la cible (target.h). Renvoie false si la
+    // cible est inatteignable.
+    bool mineBlock(const Target& target, unsigned threads = 0) {
+        // temps réel écoulé : clock() additionnerait le temps CPU des threads
+        auto start = chrono::steady_clock::now();
+
+        BlockHeader header = this->header();
+        // sonde bitslicée et hacheur incrémental : AC_HASH de rayon 1 seulement
+        // (chacun fait évoluer tout le préfixe sur AC_STEPS générations)
+        optional<AcBitslicedProbe> probe;
+        optional<AcNonceHasher> acHasher;
+        if (mode == AC_HASH_MODE && radius == 1)
+            probe.emplace(header.prefix(), rule, AC_STEPS, target_zero_bits(target), header.encoder());
+
+        // les m premiers bits du hash ne dépendent que des cellules
+        // [0, m + radius * steps) : si elles sont toutes dans le préfixe, un
+        // seul hash décide pour tous les nonces
+        size_t zeroBits = target_zero_bits(target);
+        bool unreachable = (radius == 1) ? probe && probe->unreachable()
+                         : zeroBits + AC_STEPS <= header.nonce_offset() * 8 &&
+                           target_zero_bits(calculateHash()) < zeroBits;
+        if (mode == AC_HASH_MODE && unreachable) {
+            cout << "Bloc impossible a miner : les " << zeroBits
+                 << " premiers bits du hash ne dependent pas du nonce" << endl;
+            return false;
+        }
+        // hacheur construit seulement si le nonce peut changer le résultat
+        if (probe) acHasher.emplace(header.prefix(), rule, AC_STEPS, header.encoder());
+        // SHA-256 et hash simple : état du préfixe calculé une fois (midstate)
+        Sha256NonceHasher shaHasher(header.prefix(), header.encoder());
+        SimpleHashNonceHasher simpleHasher(header.prefix(), header.encoder());
+
+        HashMode mode = this->mode;
+        uint32_t rule = this->rule;
+        int radius = this->radius;
+        nonce = parallel_nonce_search(nonce + 1, threads, [&]() {
+            return [mode, rule, radius, header, acHasher, probe, shaHasher, simpleHasher,
+                    target](int64_t n) mutable {
+                if (mode == AC2D_MODE || (mode == AC_HASH_MODE && radius == 2)) {
+                    header.set_nonce(n);
+                    return meets_target(hashHeader(header, mode, rule, radius), target);
+                }
+                if (mode == AC_HASH_MODE && !probe->passes(n)) return false;
+                Digest h = (mode == AC_HASH_MODE) ? acHasher->hash(n)
+                         : (mode == SHA256_MODE)  ? shaHasher.hash(n) // 8 nonces par lot
+                                                  : simpleHasher.hash(n);
+                return meets_target(h, target);
+            };
+        });
+        hash = calculateHash();
 
-        time_t end = clock();
+        auto end = chrono::steady_clock::now();
 
-        cout << "Bloc mine: " << hash << endl;
+        cout << "Bloc mine: " << hashToString(hash, mode) << endl;
         cout << "Temps de minage : "
-             << (double)(end - start) / CLOCKS_PER_SEC
+             << chrono::duration<double>(end - start).count()
              << " secondes" << endl;
+        return true;
     }
 };
 
 class Blockchain {
 public:
     vector<Block> chain;
-    int difficulty;
+    Target target;              // cible courante (4 chiffres '0' au depart)
+    double targetBlockTime;     // duree visee par bloc, en secondes
+    size_t retargetWindow;      // blocs entre deux reajustements
+    vector<double> blockTimes;  // durees de minage de la fenetre en cours
     HashMode mode;
     uint32_t rule;
+    int radius;
+    PreimageFormat format;
 
-    Blockchain(HashMode m = SHA256_MODE, uint32_t r = 30)
-        : mode(m), difficulty(4), rule(r) {
+    Blockchain(HashMode m = SHA256_MODE, uint32_t r = 30, int rad = 1,
+               PreimageFormat f = TEXT_PREIMAGE)
+        : target(target_from_hex_digits(4)), targetBlockTime(1.0), retargetWindow(4),
+          mode(m), rule(r), radius(rad), format(f) {
         chain.push_back(createGenesisBlock());
     }
 
     Block createGenesisBlock() {
-        return Block(0, "0", "Genesis Block", mode, rule);
+        return Block(0, Digest{}, "Genesis Block", mode, rule, radius, format);
     }
 
     Block getLatestBlock() const {
         return chain.back();
     }
 
-    void addBlock(Block newBlock) {
+    // Renvoie false si le bloc n'a pas pu etre mine (cible inatteignable) :
+    // il n'est alors pas ajoute a la chaine
+    bool addBlock(Block newBlock) {
         newBlock.previousHash = getLatestBlock().hash;
-        newBlock.mineBlock(difficulty);
+        newBlock.format = format;
+        newBlock.radius = radius;
+        auto start = chrono::steady_clock::now();
+        if (!newBlock.mineBlock(target)) return false;
         chain.push_back(newBlock);
+        blockTimes.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        if (blockTimes.size() >= retargetWindow) retarget();
+        return true;
+    }
+
+    // Reajuste la cible d'apres la duree reelle des derniers blocs : trop
+    // rapides -> cible plus basse (plus de travail), trop lents -> plus haute
+    void retarget() {
+        double actual = accumulate(blockTimes.begin(), blockTimes.end(), 0.0);
+        target = retarget_target(target, actual, targetBlockTime * blockTimes.size());
+        blockTimes.clear();
+        cout << "Nouvelle cible : " << digest_hex(target) << " (~"
+             << target_work(target) << " hashes par bloc)" << endl;
     }
 
     bool isChainValid() {
@@ -176,27 +265,47 @@ int main() {
     cout << "=== Blockchain avec Automates Cellulaires ===\n";
     cout << "1 - Hash simple \n";
     cout << "2 - AC_HASH (Automate Cellulaire Rule X)\n";
+    cout << "3 - SHA-256\n";
+    cout << "4 - AC2D (Automate Cellulaire sur un tore 2D)\n";
     
     int choix;
     cin >> choix;
 
-    int rule = 30;
+    uint32_t rule = 30;
+    int radius = 1;
     if (choix == 2) {
-        cout << "Choisir une regle AC (ex: 30, 90, 110) : ";
+        cout << "Rayon du voisinage (1 ou 2) : ";
+        cin >> radius;
+        radius = (radius == 2) ? 2 : 1;
+        cout << (radius == 1 ? "Choisir une regle AC (ex: 30, 90, 110) : "
+                             : "Choisir une regle AC de rayon 2 (table de 32 bits, ex: 1771476585) : ");
         cin >> rule;
+    } else if (choix == 4) {
+        cout << "Choisir une regle 2D (ex: " << AC2D_DEFAULT_RULE << ", B36/S23) : ";
+        string bs;
+        cin >> bs;
+        rule = ac2d_rule(bs);
     }
 
-    HashMode mode = (choix == 2) ? AC_HASH_MODE : SHA256_MODE;
-    Blockchain myChain(mode, rule);
-
-    cout << "\nAjout du bloc 1..." << endl;
-    myChain.addBlock(Block(1, myChain.getLatestBlock().hash, "A -> B", mode, rule));
-
-    cout << "\nAjout du bloc 2..." << endl;
-    myChain.addBlock(Block(2, myChain.getLatestBlock().hash, "C -> D", mode, rule));
+    HashMode mode = (choix == 2) ? AC_HASH_MODE
+                  : (choix == 3) ? SHA256_MODE
+                  : (choix == 4) ? AC2D_MODE : SIMPLE_HASH_MODE;
+    Blockchain myChain(mode, rule, radius);
+
+    const char* transactions[] = {"A -> B", "C -> D"};
+    for (int i = 1; i <= 2; ++i) {
+        cout << "\nAjout du bloc " << i << "..." << endl;
+        if (!myChain.addBlock(Block(i, myChain.getLatestBlock().hash, transactions[i - 1],
+                                    mode, rule, radius))) {
+            cerr << "Le bloc " << i << " n'a pas ete ajoute : arret (chaine de "
+                 << myChain.chain.size() << " bloc(s))" << endl;
+            return 1;
+        }
+    }
 
     cout << "\nBlockchain valide ? "
          << (myChain.isChainValid() ? "Oui" : "Non")
+         << " (" << myChain.chain.size() << " blocs)"
          << endl;
 
     return 0;
@@ -0,0 +1,76 @@
+// miner.h
+// Recherche de nonce multi-thread pour Block::mineBlock.
+//
+// L'espace des nonces est distribué par tranches de NONCE_CHUNK à N threads,
+// chacun travaillant sur sa propre copie du bloc. Les tranches sont prises
+// dans l'ordre croissant et un nonce gagnant n'est publié que s'il est plus
+// petit que le meilleur déjà trouvé : toutes les valeurs inférieures au
+// résultat ont donc été testées, et on obtient exactement le nonce qu'aurait
+// trouvé la boucle séquentielle `nonce++`, quel que soit le nombre de threads.
+// Dès qu'un nonce est trouvé, les threads dont la tranche est au-delà
+// s'arrêtent sans attendre.
+//
+// Compilation : g++ -O2 -std=c++17 -pthread ...
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+const int64_t NONCE_CHUNK = 256;
+
+// Écriture du nonce à la fin du message (au plus NONCE_MAX_BYTES octets).
+// Par défaut : ses chiffres décimaux, comme `ss << nonce`.
+const size_t NONCE_MAX_BYTES = 24;
+typedef size_t (*NonceEncoder)(int64_t nonce, char* out);
+
+inline size_t decimal_nonce(int64_t nonce, char* out) {
+    return (size_t)(std::to_chars(out, out + NONCE_MAX_BYTES, nonce).ptr - out);
+}
+
+inline unsigned default_mining_threads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+// makeWorker() est appelé une fois par thread et renvoie un objet appelable
+// bool(int64_t nonce) qui teste un nonce sur sa propre copie du bloc.
+// Renvoie le plus petit nonce >= first accepté par les workers.
+template <class MakeWorker>
+int64_t parallel_nonce_search(int64_t first, unsigned threads, MakeWorker makeWorker) {
+    if (threads == 0) threads = default_mining_threads();
+
+    std::atomic<int64_t> nextChunk(first);
+    std::atomic<int64_t> best(INT64_MAX);
+
+    auto run = [&]() {
+        auto tryNonce = makeWorker();
+        for (;;) {
+            int64_t start = nextChunk.fetch_add(NONCE_CHUNK);
+            if (start >= best.load(std::memory_order_relaxed)) return;
+            for (int64_t nonce = start; nonce < start + NONCE_CHUNK; ++nonce) {
+                if (nonce >= best.load(std::memory_order_relaxed)) return;
+                if (tryNonce(nonce)) {
+                    int64_t cur = best.load();
+                    while (nonce < cur && !best.compare_exchange_weak(cur, nonce)) {}
+                    return;
+                }
+            }
+        }
+    };
+
+    if (threads == 1) {
+        run();
+    } else {
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; ++t)
+            pool.emplace_back(run);
+        for (std::thread& th : pool)
+            th.join();
+    }
+    return best.load();
+}
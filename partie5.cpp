@@ -6,92 +6,44 @@
 #include <bitset>
 #include <cstdint>
 #include <ctime>
+#include <chrono>
+#include "ac_engine.h"
+#include "ac2d.h"
+#include "ac_rng.h"
+#include "sac.h"
+#include "digest.h"
 #include <cmath>
+#include <cstdlib>
 using namespace std;
 
 // ===========================================================
 // ============ FONCTION AC_HASH =============================
 // ===========================================================
 
-int apply_rule(uint32_t rule, int left, int center, int right) {
-    int index = left * 4 + center * 2 + right;
-    return (rule >> index) & 1;
-}
+// apply_rule, evolve, text_to_bits : voir ac_engine.h
 
-vector<int> evolve(const vector<int>& state, uint32_t rule) {
-    int n = state.size();
-    vector<int> next_state(n, 0);
-    for (int i = 0; i < n; i++) {
-        int left   = (i == 0) ? 0 : state[i-1];
-        int center = state[i];
-        int right  = (i == n-1) ? 0 : state[i+1];
-        next_state[i] = apply_rule(rule, left, center, right);
-    }
-    return next_state;
+Digest ac_hash_bytes(const char* input, size_t len, uint32_t rule = 30, size_t steps = 20) {
+    PackedState state = pack_bytes(input, len);
+    evolve_packed(state, rule, steps, ZERO_BOUNDARY);
+    return packed_to_digest(state, 256);
 }
 
-vector<int> text_to_bits(const string& input) {
-    vector<int> bits;
-    for (char c : input) {
-        bitset<8> b(c);
-        for (int i = 7; i >= 0; --i)
-            bits.push_back(b[i]);
-    }
-    return bits;
+Digest ac_hash(const string& input, uint32_t rule = 30, size_t steps = 20) {
+    return ac_hash_bytes(input.data(), input.size(), rule, steps);
 }
 
-string ac_hash(const string& input, uint32_t rule = 30, size_t steps = 20) {
-    vector<int> state = text_to_bits(input);
-    for (size_t i = 0; i < steps; ++i)
-        state = evolve(state, rule);
-
-    vector<int> hash_bits(256, 0);
-    for (size_t i = 0; i < 256; ++i)
-        hash_bits[i] = state[i % state.size()];
-
-    string hash_str = "";
-    for (size_t i = 0; i < 256; i += 4) {
-        int val = hash_bits[i]*8 + hash_bits[i+1]*4 + hash_bits[i+2]*2 + hash_bits[i+3];
-        hash_str += "0123456789ABCDEF"[val];
-    }
-
-    return hash_str;
-}
+// Fonctions comparées : AC_HASH 1D (règle 30, 20 générations) et AC2D
+// (ac2d.h, règle et nombre de générations par défaut)
+Digest ac_hash_1d(const string& input) { return ac_hash(input, 30, 20); }
+Digest ac_hash_2d(const string& input) { return ac2d_hash(input); }
 
 // ===========================================================
 // ============ PARTIE 5 : EFFET AVALANCHE ===================
 // ===========================================================
 
-// Convertir une chaîne hexadécimale en bits
-vector<int> hexToBits(const string& hexStr) {
-    vector<int> bits;
-    for (char c : hexStr) {
-        int val;
-        if (c >= '0' && c <= '9') val = c - '0';
-        else if (c >= 'A' && c <= 'F') val = c - 'A' + 10;
-        else if (c >= 'a' && c <= 'f') val = c - 'a' + 10;
-        else continue;
-
-        for (int i = 3; i >= 0; --i)
-            bits.push_back((val >> i) & 1);
-    }
-    return bits;
-}
-
-// Compter le nombre de bits différents entre deux hashes
-int countDifferentBits(const string& hash1, const string& hash2) {
-    vector<int> bits1 = hexToBits(hash1);
-    vector<int> bits2 = hexToBits(hash2);
-
-    int count = 0;
-    int minSize = min(bits1.size(), bits2.size());
-
-    for (int i = 0; i < minSize; ++i) {
-        if (bits1[i] != bits2[i])
-            count++;
-    }
-
-    return count;
+// Compter le nombre de bits différents entre deux hashes (4 popcnt)
+int countDifferentBits(const Digest& hash1, const Digest& hash2) {
+    return digest_hamming(hash1, hash2);
 }
 
 // Inverser un bit dans une chaîne (à une position donnée en bits)
@@ -107,14 +59,18 @@ string flipBitInString(const string& input, int bitPosition) {
     return result;
 }
 
-// 5.1 - Analyse de l'effet avalanche
-void analyzeAvalancheEffect(int numTests = 100) {
+// 5.1 - Analyse de l'effet avalanche de hashFn. Les bits modifiés sont tirés
+// de Rule30Rng(seed) : même graine, mêmes tests.
+void analyzeAvalancheEffect(const string& label, Digest (*hashFn)(const string&),
+                            uint64_t seed, int numTests = 100) {
     cout << "  " << endl;
     cout << "       PARTIE 5 : ANALYSE DE L'EFFET AVALANCHE            " << endl;
     cout << " \n" << endl;
 
     cout << "Configuration :" << endl;
+    cout << "  - Fonction : " << label << endl;
     cout << "  - Nombre de tests : " << numTests << endl;
+    cout << "  - Graine : " << seed << endl;
     cout << "  - Taille du hash : 256 bits (64 caractères hexadécimaux)" << endl;
     cout << "  - Méthode : Modifier 1 bit aléatoire dans le message d'entrée\n" << endl;
 
@@ -123,7 +79,7 @@ void analyzeAvalancheEffect(int numTests = 100) {
     vector<double> percentages;
     vector<int> bitCounts;
 
-    srand(time(nullptr));
+    Rule30Rng rng(seed);
 
     // Exemples détaillés pour les 5 premiers tests
     cout << "EXEMPLES DÉTAILLÉS (5 premiers tests) :\n" << endl;
@@ -135,14 +91,14 @@ void analyzeAvalancheEffect(int numTests = 100) {
         string message = ss.str();
 
         // Calculer le hash original
-        string hash1 = ac_hash(message, 30, 20);
+        Digest hash1 = hashFn(message);
 
         // Modifier un seul bit aléatoire
-        int bitToFlip = rand() % (message.length() * 8);
+        int bitToFlip = (int)rng.below(message.length() * 8);
         string modifiedMessage = flipBitInString(message, bitToFlip);
 
         // Calculer le hash modifié
-        string hash2 = ac_hash(modifiedMessage, 30, 20);
+        Digest hash2 = hashFn(modifiedMessage);
 
         // Compter les bits différents
         int differentBits = countDifferentBits(hash1, hash2);
@@ -156,8 +112,8 @@ void analyzeAvalancheEffect(int numTests = 100) {
             cout << "Test #" << (test + 1) << " :" << endl;
             cout << "  Message original  : \"" << message.substr(0, 40) << "...\"" << endl;
             cout << "  Bit modifie      : position " << bitToFlip << endl;
-            cout << "  Hash original     : " << hash1.substr(0, 20) << "..." << endl;
-            cout << "  Hash modifie      : " << hash2.substr(0, 20) << "..." << endl;
+            cout << "  Hash original     : " << digest_hex(hash1, 20, true) << "..." << endl;
+            cout << "  Hash modifie      : " << digest_hex(hash2, 20, true) << "..." << endl;
             cout << "  Bits differents   : " << differentBits << " / 256" << endl;
             cout << "  Pourcentage       : " << fixed << setprecision(2) << percentage << " %\n" << endl;
         }
@@ -222,17 +178,62 @@ void analyzeAvalancheEffect(int numTests = 100) {
 
 }
 
+// 5.3 - Critère d'avalanche strict sur tous les cœurs (sac.h) : matrice
+// bit d'entrée x bit de sortie et indépendance des bits de sortie, écrites
+// dans <fichier>.csv et <fichier>_summary.csv
+template <class Hash>
+void analyzeStrictAvalanche(const string& label, const string& file, Hash hash,
+                            size_t msgBytes, size_t trials, uint64_t seed) {
+    cout << "\n       PARTIE 5.3 : CRITERE D'AVALANCHE STRICT (SAC)       " << endl;
+    cout << "  - Fonction : " << label << endl;
+    cout << "  - " << trials << " messages de " << msgBytes << " octets, chaque bit inverse ("
+         << trials * msgBytes * 8 << " hashes), " << default_mining_threads() << " threads" << endl;
+
+    auto start = chrono::steady_clock::now();
+    SacResult r = sac_analyze(hash, msgBytes, trials, seed);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << fixed << setprecision(4);
+    cout << " Probabilite moyenne de changement    : " << r.mean_probability() << " (ideal 0.5)" << endl;
+    cout << " Pire ecart |p - 0.5|                 : " << r.max_bias()
+         << " (bruit ~" << 0.5 / sqrt((double)r.trials) << ")" << endl;
+    cout << " Cases hors de 0.5 +/- 3 sigma        : " << 100 * r.biased_fraction() << " %" << endl;
+    cout << " BIC : |correlation| max              : " << r.bic_max()
+         << " (bruit ~" << 1 / sqrt((double)r.trials) << ")" << endl;
+    cout << " BIC : paires sans correlation definie: " << r.bicUndefined << endl;
+    cout << " Duree                                : " << setprecision(2) << seconds << " s ("
+         << r.trials * r.inBits / seconds / 1e6 << " M hashes/s)" << endl;
+
+    if (sac_write_matrix_csv(r, file + ".csv") && sac_write_summary_csv(r, file + "_summary.csv"))
+        cout << " Resultats : " << file << ".csv, " << file << "_summary.csv" << endl;
+    else
+        cout << " Impossible d'ecrire " << file << ".csv" << endl;
+}
+
 // ===========================================================
 // ===================== MAIN ================================
 // ===========================================================
 
-int main() {
+// Usage : partie5 [graine] [messages SAC] [octets par message]
+int main(int argc, char** argv) {
+    uint64_t seed = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1;
+    size_t sacTrials = argc > 2 ? strtoull(argv[2], nullptr, 10) : 4096;
+    size_t sacBytes = argc > 3 ? strtoull(argv[3], nullptr, 10) : 32;
 
     cout << "         PARTIE 5 - TEST EFFET AVALANCHE AC_HASH         " << endl;
 
 
     // 5.1 & 5.2 : Analyser l'effet avalanche avec 100 tests
-    analyzeAvalancheEffect(100);
+    analyzeAvalancheEffect("AC_HASH 1D (regle 30, 20 generations)", ac_hash_1d, seed, 100);
+    analyzeAvalancheEffect(string("AC2D (") + AC2D_DEFAULT_RULE + ")", ac_hash_2d, seed, 100);
+
+    // 5.3 : SAC / BIC complets
+    analyzeStrictAvalanche("AC_HASH 1D (regle 30, 20 generations)", "sac_ac_hash_1d",
+                           [](const char* p, size_t n) { return ac_hash_bytes(p, n, 30, 20); },
+                           sacBytes, sacTrials, seed);
+    analyzeStrictAvalanche(string("AC2D (") + AC2D_DEFAULT_RULE + ")", "sac_ac2d",
+                           [](const char* p, size_t n) { return ac2d_hash(p, n); },
+                           sacBytes, sacTrials, seed);
 
     return 0;
 }
\ No newline at end of file
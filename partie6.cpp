@@ -6,97 +6,53 @@
 #include <bitset>
 #include <cstdint>
 #include <ctime>
+#include <chrono>
+#include "ac_engine.h"
+#include "ac2d.h"
+#include "ac_rng.h"
+#include "stat_tests.h"
+#include "digest.h"
 #include <cmath>
+#include <cstdlib>
 using namespace std;
 
-int apply_rule(uint32_t rule, int left, int center, int right) {
-    int index = left * 4 + center * 2 + right;
-    return (rule >> index) & 1;
-}
-
-vector<int> evolve(const vector<int>& state, uint32_t rule) {
-    int n = state.size();
-    vector<int> next_state(n, 0);
-    for (int i = 0; i < n; i++) {
-        int left   = (i == 0) ? 0 : state[i-1];
-        int center = state[i];
-        int right  = (i == n-1) ? 0 : state[i+1];
-        next_state[i] = apply_rule(rule, left, center, right);
-    }
-    return next_state;
-}
-
-vector<int> text_to_bits(const string& input) {
-    vector<int> bits;
-    for (char c : input) {
-        bitset<8> b(c);
-        for (int i = 7; i >= 0; --i)
-            bits.push_back(b[i]);
-    }
-    return bits;
-}
-
-string ac_hash(const string& input, uint32_t rule = 30, size_t steps = 20) {
-    vector<int> state = text_to_bits(input);
-    for (size_t i = 0; i < steps; ++i)
-        state = evolve(state, rule);
-
-    vector<int> hash_bits(256, 0);
-    for (size_t i = 0; i < 256; ++i)
-        hash_bits[i] = state[i % state.size()];
-
-    string hash_str = "";
-    for (size_t i = 0; i < 256; i += 4) {
-        int val = hash_bits[i]*8 + hash_bits[i+1]*4 + hash_bits[i+2]*2 + hash_bits[i+3];
-        hash_str += "0123456789ABCDEF"[val];
-    }
+// apply_rule, evolve, text_to_bits : voir ac_engine.h
 
-    return hash_str;
+Digest ac_hash(const string& input, uint32_t rule = 30, size_t steps = 20) {
+    PackedState state = pack_text(input);
+    evolve_packed(state, rule, steps, ZERO_BOUNDARY);
+    return packed_to_digest(state, 256);
 }
 
-vector<int> hexToBits(const string& hexStr) {
-    vector<int> bits;
-    for (char c : hexStr) {
-        int val;
-        if (c >= '0' && c <= '9') val = c - '0';
-        else if (c >= 'A' && c <= 'F') val = c - 'A' + 10;
-        else if (c >= 'a' && c <= 'f') val = c - 'a' + 10;
-        else continue;
-        
-        for (int i = 3; i >= 0; --i)
-            bits.push_back((val >> i) & 1);
-    }
-    return bits;
-}
+// AC_HASH 1D (règle 30, 20 générations) et AC2D (ac2d.h, réglages par défaut)
+Digest ac_hash_1d(const string& input) { return ac_hash(input, 30, 20); }
+Digest ac_hash_2d(const string& input) { return ac2d_hash(input); }
 
-void analyzeBitDistribution(int numHashes = 400) {
-    cout << "PARTIE 6 - Distribution des bits\n\n";
+// Messages tirés de Rule30Rng(seed) : même graine, mêmes messages
+void analyzeBitDistribution(const string& label, Digest (*hashFn)(const string&),
+                            uint64_t seed, int numHashes = 400) {
+    cout << "PARTIE 6 - Distribution des bits : " << label << "\n\n";
 
     int bitsPerHash = 256;
     int totalBits = numHashes * bitsPerHash;
 
-    srand(time(nullptr));
+    Rule30Rng rng(seed);
 
     int countOnes = 0;
     int countZeros = 0;
-    vector<int> allBits;
 
     for (int i = 0; i < numHashes; ++i) {
         stringstream ss;
-        ss << "Message test " << i << " " << rand();
+        ss << "Message test " << i << " " << rng();
         string message = ss.str();
         
-        string hash = ac_hash(message, 30, 20);
-        vector<int> bits = hexToBits(hash);
-        
-        for (int bit : bits) {
-            allBits.push_back(bit);
-            if (bit == 1) countOnes++;
-            else countZeros++;
-        }
+        Digest hash = hashFn(message);
+        int ones = digest_popcount(hash);
+        countOnes += ones;
+        countZeros += bitsPerHash - ones;
     }
 
-    int totalBitsCollected = allBits.size();
+    int totalBitsCollected = countOnes + countZeros;
     double percentageOnes = (countOnes * 100.0) / totalBitsCollected;
     double percentageZeros = (countZeros * 100.0) / totalBitsCollected;
     double deviation = abs(percentageOnes - 50.0);
@@ -126,7 +82,51 @@ void analyzeBitDistribution(int numHashes = 400) {
     cout << "] " << percentageZeros << "%\n";
 }
 
-int main() {
-    analyzeBitDistribution(400);
+// 6.2 - Batterie de tests statistiques (stat_tests.h) sur `megabytes` Mo de
+// hashes, calculés et testés en flux sur tous les cœurs. Le segment i
+// contient les hashes des messages "Message test k x", k = i * 4096 ...,
+// x tiré de Rule30Rng(seed, i) : la suite ne dépend pas du nombre de threads.
+void runStatBattery(const string& label, Digest (*hashFn)(const string&),
+                    uint64_t seed, size_t megabytes) {
+    const size_t hashesPerSegment = STAT_SEGMENT_WORDS / DIGEST_WORDS;
+    size_t segments = max<size_t>(1, megabytes * 8 * 1024 * 1024 / STAT_SEGMENT_BITS);
+    cout << "\nPARTIE 6.2 - Batterie de tests : " << label << "\n";
+    cout << segments * STAT_SEGMENT_BITS / 8 / (1024 * 1024) << " Mo ("
+         << segments * hashesPerSegment << " hashes), "
+         << default_mining_threads() << " threads\n\n";
+
+    auto start = chrono::steady_clock::now();
+    StatReport report = stat_battery(segments, [&](size_t seg, uint64_t* w) {
+        Rule30Rng rng(seed, seg);
+        for (size_t j = 0; j < hashesPerSegment; ++j) {
+            Digest h = hashFn("Message test " + to_string(seg * hashesPerSegment + j) +
+                              " " + to_string(rng()));
+            for (size_t k = 0; k < DIGEST_WORDS; ++k) w[j * DIGEST_WORDS + k] = h.word(k);
+        }
+    });
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    int passed = 0;
+    for (const StatTestResult& t : report.tests) {
+        cout << left << setw(36) << t.name << right << " p = " << scientific << setprecision(4)
+             << t.p << fixed << (t.passed() ? "  OK" : "  ECHEC") << "\n";
+        passed += t.passed();
+    }
+    cout << passed << " / " << report.tests.size() << " tests reussis (seuil p >= "
+         << STAT_ALPHA << "), " << setprecision(2) << seconds << " s ("
+         << report.bits / seconds / 1e6 << " Mbit/s)\n";
+}
+
+// Usage : partie6 [graine] [Mo pour la batterie]
+int main(int argc, char** argv) {
+    uint64_t seed = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1;
+    size_t megabytes = argc > 2 ? strtoull(argv[2], nullptr, 10) : 8;
+    cout << "Graine : " << seed << "\n\n";
+    analyzeBitDistribution("AC_HASH 1D", ac_hash_1d, seed, 400);
+    cout << "\n";
+    analyzeBitDistribution("AC2D", ac_hash_2d, seed, 400);
+
+    runStatBattery("AC_HASH 1D", ac_hash_1d, seed, megabytes);
+    runStatBattery("AC2D", ac_hash_2d, seed, megabytes);
     return 0;
 }
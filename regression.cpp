@@ -0,0 +1,844 @@
+// regression.cpp
+// Garde-fou de non-régression pour les noyaux de hachage.
+//
+// 1. Tests différentiels : chaque chemin optimisé est comparé, sur des
+//    entrées aléatoires, à une référence écrite naïvement (une cellule par
+//    int, bords par indices) :
+//      - evolve_packed (avance rapide linéaire comprise), noyaux spécialisés
+//        et génériques de chaque jeu d'instructions disponible, blocage
+//        temporel (LUT) : les 256 règles, bord nul et périodique, de 0 à
+//        10 000 cellules ;
+//      - règles de rayon 2, sortie du hash (packed_to_digest), ac_hash ;
+//      - minage AC : AcNonceHasher, sondes AcDifficultyProbe et
+//        AcBitslicedProbe ;
+//      - SHA-256 (vecteurs connus, SHA-NI, 8 voies AVX2, midstate), hash
+//        simple par lots, codec hexadécimal ;
+//      - éponge et arbre AC, automate 2D (petites grilles et bandes),
+//        Rule30Rng (AVX2 contre SSE).
+//    Les entrées sont tirées de Rule30Rng(--seed) : un échec se reproduit.
+// 2. Débits : quelques mesures de référence, comparées au fichier de
+//    référence (--baseline) ; un débit inférieur à (1 - seuil) fois la
+//    référence est un échec. Les débits dépendent de la machine : le fichier
+//    a une section par machine (processeur, fréquence, cœurs, noyau AC,
+//    SHA-256), et --update-baseline y réécrit celle de la machine courante
+//    avec un percentile bas de plusieurs mesures. Sans section pour cette
+//    machine (fichier absent ou vide, mesures d'un autre processeur, dites
+//    "non comparables"), ou s'il y manque un débit, le garde-fou échoue.
+// Code de sortie : 0 si tout passe, 1 sinon (run_tests.bat s'arrête).
+//
+// Compilation : g++ -O2 -std=c++17 -pthread regression.cpp -o regression
+// Usage : regression [--seed 1] [--cases 4] [--baseline regression_baseline.txt]
+//                    [--threshold 0.25] [--update-baseline] [--no-bench]
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ac2d.h"
+#include "ac_bitslice.h"
+#include "ac_engine.h"
+#include "ac_incremental.h"
+#include "ac_rng.h"
+#include "ac_sponge.h"
+#include "ac_tree.h"
+#include "block_header.h"
+#include "digest.h"
+#include "sha256.h"
+#include "simple_hash.h"
+using namespace std;
+
+const size_t MAX_CELLS = 10000;
+
+// ===========================================================
+// =================== RÉFÉRENCES NAÏVES =====================
+// ===========================================================
+
+// `steps` générations, bord nul (evolve des exercices) ou périodique
+vector<int> reference_evolve(vector<int> s, uint32_t rule, size_t steps, Boundary boundary,
+                             int radius = 1) {
+    int n = (int)s.size();
+    for (size_t t = 0; t < steps && n > 0; ++t) {
+        if (boundary == ZERO_BOUNDARY) {
+            s = radius == 2 ? evolve_r2(s, rule) : evolve(s, rule);
+            continue;
+        }
+        auto cell = [&](int i) { return s[((i % n) + n) % n]; };
+        vector<int> next(n);
+        for (int i = 0; i < n; ++i)
+            next[i] = radius == 2
+                ? apply_rule_r2(rule, cell(i - 2), cell(i - 1), s[i], cell(i + 1), cell(i + 2))
+                : apply_rule(rule, cell(i - 1), s[i], cell(i + 1));
+        s = next;
+    }
+    return s;
+}
+
+// 256 bits de hash : bit i = cellule i % n, bit de poids fort d'abord
+Digest reference_digest(const vector<int>& cells) {
+    Digest d{};
+    if (cells.empty()) return d;
+    for (size_t i = 0; i < 256; ++i)
+        if (cells[i % cells.size()]) d[i / 8] |= (uint8_t)(0x80 >> (i % 8));
+    return d;
+}
+
+// ac_hash des exercices : bits du texte, evolve, 256 bits
+Digest reference_ac_hash(const string& msg, uint32_t rule, size_t steps) {
+    return reference_digest(reference_evolve(text_to_bits(msg), rule, steps, ZERO_BOUNDARY));
+}
+
+// Tore 2D : règle lue à l'index centre * 16 + nombre de voisines à 1
+Grid2D reference_evolve_2d(Grid2D g, uint32_t rule, size_t steps) {
+    size_t W = g.width, H = g.height;
+    for (size_t t = 0; t < steps; ++t) {
+        Grid2D next(W, H);
+        for (size_t y = 0; y < H; ++y)
+            for (size_t x = 0; x < W; ++x) {
+                int count = 0;
+                for (int dy = -1; dy <= 1; ++dy)
+                    for (int dx = -1; dx <= 1; ++dx)
+                        if (dx || dy) count += g.get((x + W + dx) % W, (y + H + dy) % H);
+                next.set(x, y, (rule >> (g.get(x, y) * 16 + count)) & 1);
+            }
+        g = next;
+    }
+    return g;
+}
+
+// Repliement : cellule j = (j % W, j / W) XORée dans le bit j % 256
+Digest reference_2d_digest(const Grid2D& g) {
+    Digest d{};
+    for (size_t y = 0; y < g.height; ++y)
+        for (size_t x = 0; x < g.width; ++x) {
+            size_t bit = (y * g.width + x) % 256;
+            if (g.get(x, y)) d[bit / 8] ^= (uint8_t)(0x80 >> (bit % 8));
+        }
+    return d;
+}
+
+// ===========================================================
+// ================= BILAN DES VÉRIFICATIONS =================
+// ===========================================================
+
+struct CheckResult {
+    string name;
+    size_t cases = 0, failures = 0;
+    string firstFailure;
+};
+
+class CheckLog {
+public:
+    // describe() n'est appelé qu'en cas d'échec
+    void expect(const string& check, bool ok, const function<string()>& describe) {
+        CheckResult& r = get(check);
+        ++r.cases;
+        if (ok) return;
+        if (r.failures++ == 0) r.firstFailure = describe();
+    }
+
+    bool print() const {
+        bool allOk = true;
+        for (const CheckResult& r : results_) {
+            bool ok = r.failures == 0;
+            allOk &= ok;
+            cout << (ok ? "[PASS] " : "[FAIL] ") << left << setw(34) << r.name << right
+                 << setw(7) << r.cases << " cases";
+            if (!ok) cout << ", " << r.failures << " mismatches (first: " << r.firstFailure << ")";
+            cout << "\n";
+        }
+        return allOk;
+    }
+
+private:
+    CheckResult& get(const string& name) {
+        auto it = index_.find(name);
+        if (it != index_.end()) return results_[it->second];
+        index_[name] = results_.size();
+        results_.push_back(CheckResult());
+        results_.back().name = name;
+        return results_.back();
+    }
+
+    vector<CheckResult> results_;
+    map<string, size_t> index_;
+};
+
+// ===========================================================
+// ================= TESTS DIFFÉRENTIELS =====================
+// ===========================================================
+
+vector<KernelIsa> available_isas() {
+    vector<KernelIsa> isas;
+    for (KernelIsa isa : {ISA_SCALAR, ISA_AVX2, ISA_AVX512})
+        if (cpu_supports_isa(isa)) isas.push_back(isa);
+    return isas;
+}
+
+const char* boundary_name(Boundary b) { return b == ZERO_BOUNDARY ? "zero" : "periodic"; }
+
+// Longueurs : cas limites autour des mots de 64 bits, ou tirage uniforme
+size_t random_length(Rule30Rng& rng) {
+    static const size_t edges[] = {0, 1, 2, 3, 5, 63, 64, 65, 127, 128, 129, 255, 256,
+                                   257, 511, 512, 513, 4095, 4096, 4097, MAX_CELLS};
+    if (rng.below(2)) return edges[rng.below(sizeof(edges) / sizeof(edges[0]))];
+    return (size_t)rng.below(MAX_CELLS + 1);
+}
+
+// Générations : petits nombres, seuils de l'avance rapide linéaire (16, 128)
+size_t random_steps(Rule30Rng& rng) {
+    static const size_t steps[] = {0, 1, 2, 3, 4, 5, 7, 8, 15, 16, 17, 31, 33, 127, 128, 129, 200};
+    return steps[rng.below(sizeof(steps) / sizeof(steps[0]))];
+}
+
+vector<int> random_cells(Rule30Rng& rng, size_t n) {
+    vector<int> cells(n);
+    for (size_t i = 0; i < n; i += 64) {
+        uint64_t w = rng();
+        for (size_t k = 0; k < 64 && i + k < n; ++k) cells[i + k] = (w >> k) & 1;
+    }
+    return cells;
+}
+
+string random_bytes(Rule30Rng& rng, size_t n) {
+    string s(n, '\0');
+    for (char& c : s) c = (char)rng();
+    return s;
+}
+
+void check_radius1(CheckLog& log, Rule30Rng& rng, size_t casesPerRule) {
+    vector<KernelIsa> isas = available_isas();
+    for (uint32_t rule = 0; rule < 256; ++rule) {
+        for (Boundary b : {ZERO_BOUNDARY, PERIODIC_BOUNDARY}) {
+            for (size_t c = 0; c < casesPerRule; ++c) {
+                size_t n = random_length(rng), steps = random_steps(rng);
+                vector<int> cells = random_cells(rng, n);
+                vector<int> expected = reference_evolve(cells, rule, steps, b);
+                auto context = [&] {
+                    ostringstream o;
+                    o << "rule " << rule << ", " << boundary_name(b) << ", n=" << n
+                      << ", steps=" << steps;
+                    return o.str();
+                };
+                auto run = [&](const string& name, const function<void(PackedState&)>& evolveFn) {
+                    PackedState s = pack_cells(cells);
+                    evolveFn(s);
+                    log.expect(name, unpack_cells<int>(s) == expected, context);
+                };
+                run("evolve_packed/auto", [&](PackedState& s) { evolve_packed(s, rule, steps, b); });
+                for (KernelIsa isa : isas) {
+                    string tag = kernel_isa_name(isa);
+                    run("evolve_packed/" + tag,
+                        [&](PackedState& s) { evolve_packed(s, rule, steps, b, isa); });
+                    run("evolve_packed_generic/" + tag,
+                        [&](PackedState& s) { evolve_packed_generic(s, rule, steps, b, isa); });
+                }
+                run("evolve_packed_lut", [&](PackedState& s) { evolve_packed_lut(s, rule, steps, b); });
+
+                PackedState s = pack_cells(expected);
+                log.expect("packed_to_digest", packed_to_digest(s, 256) == reference_digest(expected),
+                           context);
+            }
+        }
+    }
+}
+
+void check_radius2(CheckLog& log, Rule30Rng& rng, size_t cases) {
+    vector<KernelIsa> isas = available_isas();
+    for (size_t c = 0; c < cases; ++c) {
+        uint32_t rule = (uint32_t)rng();
+        Boundary b = rng.below(2) ? PERIODIC_BOUNDARY : ZERO_BOUNDARY;
+        size_t n = random_length(rng), steps = random_steps(rng) % 40;
+        vector<int> cells = random_cells(rng, n);
+        vector<int> expected = reference_evolve(cells, rule, steps, b, 2);
+        auto context = [&] {
+            ostringstream o;
+            o << "rule 0x" << hex << rule << dec << ", " << boundary_name(b) << ", n=" << n
+              << ", steps=" << steps;
+            return o.str();
+        };
+        for (KernelIsa isa : isas) {
+            PackedState s = pack_cells(cells);
+            evolve_packed_r2(s, rule, steps, b, isa);
+            log.expect(string("evolve_packed_r2/") + kernel_isa_name(isa),
+                       unpack_cells<int>(s) == expected, context);
+        }
+    }
+}
+
+void check_ac_hash(CheckLog& log, Rule30Rng& rng, size_t cases) {
+    for (size_t c = 0; c < cases; ++c) {
+        uint32_t rule = (uint32_t)rng.below(256);
+        size_t steps = random_steps(rng);
+        string msg = random_bytes(rng, rng.below(MAX_CELLS / 8 + 1));
+        PackedState s = pack_bytes(msg.data(), msg.size());
+        evolve_packed(s, rule, steps, ZERO_BOUNDARY);
+        log.expect("ac_hash (pack_bytes)", packed_to_digest(s, 256) == reference_ac_hash(msg, rule, steps),
+                   [&] { return "rule " + to_string(rule) + ", " + to_string(msg.size()) + " bytes"; });
+    }
+}
+
+// Hash complet et sondes du minage AC contre ac_hash(prefix + nonce)
+void check_ac_mining(CheckLog& log, Rule30Rng& rng, size_t cases) {
+    for (size_t c = 0; c < cases; ++c) {
+        uint32_t rule = rng.below(4) ? 30 : (uint32_t)rng.below(256);
+        size_t steps = 1 + rng.below(150);
+        string prefix = random_bytes(rng, rng.below(120));
+        bool binary = rng.below(2);
+        NonceEncoder encode = nonce_encoder(binary ? BINARY_PREIMAGE : TEXT_PREIMAGE);
+        size_t zeroBits = 1 + rng.below(6);
+
+        AcNonceHasher hasher(prefix, rule, steps, encode);
+        AcDifficultyProbe probe(prefix, rule, steps, zeroBits, encode);
+        AcBitslicedProbe sliced(prefix, rule, steps, zeroBits, encode);
+        int64_t first = (int64_t)rng.below(1000000);
+        for (int64_t nonce = first; nonce < first + 80; ++nonce) {
+            char digits[NONCE_MAX_BYTES];
+            string msg = prefix + string(digits, encode(nonce, digits));
+            Digest expected = reference_ac_hash(msg, rule, steps);
+            bool zeros = true;
+            for (size_t i = 0; i < zeroBits; ++i) zeros &= !expected.bit(i);
+            auto context = [&] {
+                ostringstream o;
+                o << "rule " << rule << ", steps " << steps << ", prefix " << prefix.size()
+                  << " bytes, " << (binary ? "binary" : "decimal") << " nonce " << nonce;
+                return o.str();
+            };
+            log.expect("AcNonceHasher", hasher.hash(nonce) == expected, context);
+            log.expect("AcDifficultyProbe", probe.passes(nonce) == zeros, context);
+            log.expect("AcBitslicedProbe", sliced.passes(nonce) == zeros, context);
+        }
+    }
+}
+
+void check_sha256(CheckLog& log, Rule30Rng& rng, size_t cases) {
+    struct Vector { string msg, hex; };
+    const Vector vectors[] = {
+        {"", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+        {"abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+        {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+         "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+        {string(1000000, 'a'), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+    };
+    vector<Sha256Impl> impls;
+    for (Sha256Impl impl : {SHA256_PORTABLE, SHA256_SHANI, SHA256_AVX2_X8})
+        if (cpu_supports_sha256(impl)) impls.push_back(impl);
+
+    for (const Vector& v : vectors) {
+        uint8_t out[SHA256_DIGEST_BYTES];
+        for (Sha256Impl impl : impls) {
+            if (impl == SHA256_AVX2_X8) continue; // 8 voies : testé ci-dessous
+            Sha256 ctx(impl == SHA256_SHANI ? sha256_compress() : sha256_compress_portable);
+            ctx.update(v.msg.data(), v.msg.size());
+            ctx.finalize(out);
+            Digest d;
+            memcpy(d.data(), out, SHA256_DIGEST_BYTES);
+            log.expect(string("sha256 vectors/") + sha256_impl_name(impl), digest_hex(d) == v.hex,
+                       [&] { return to_string(v.msg.size()) + "-byte vector"; });
+        }
+    }
+
+    for (size_t c = 0; c < cases; ++c) {
+        size_t len = rng.below(300);
+        vector<string> msgs(SHA256_LANES);
+        const uint8_t* ptrs[SHA256_LANES];
+        for (int L = 0; L < SHA256_LANES; ++L) {
+            msgs[L] = random_bytes(rng, len);
+            ptrs[L] = (const uint8_t*)msgs[L].data();
+        }
+        Digest expected[SHA256_LANES];
+        for (int L = 0; L < SHA256_LANES; ++L) {
+            Sha256 ctx(sha256_compress_portable);
+            // découpage aléatoire : update() en plusieurs morceaux
+            size_t cut = len ? rng.below(len) : 0;
+            ctx.update(msgs[L].data(), cut);
+            ctx.update(msgs[L].data() + cut, len - cut);
+            ctx.finalize(expected[L].data());
+        }
+        for (Sha256Impl impl : impls) {
+            Digest out[SHA256_LANES];
+            sha256_x8(ptrs, len, out, impl);
+            bool ok = true;
+            for (int L = 0; L < SHA256_LANES; ++L) ok &= out[L] == expected[L];
+            log.expect(string("sha256_x8/") + sha256_impl_name(impl), ok,
+                       [&] { return to_string(len) + " bytes"; });
+        }
+        log.expect("sha256_digest", sha256_digest(msgs[0].data(), len) == expected[0],
+                   [&] { return to_string(len) + " bytes"; });
+
+        // minage : midstate du préfixe + nonce, lots de 8
+        string prefix = random_bytes(rng, rng.below(200));
+        NonceEncoder encode = nonce_encoder(rng.below(2) ? BINARY_PREIMAGE : TEXT_PREIMAGE);
+        Sha256NonceHasher shaHasher(prefix, encode);
+        SimpleHashNonceHasher simpleHasher(prefix, encode);
+        int64_t first = (int64_t)rng.below(1u << 30);
+        for (int64_t nonce = first; nonce < first + 20; ++nonce) {
+            char digits[NONCE_MAX_BYTES];
+            string msg = prefix + string(digits, encode(nonce, digits));
+            auto context = [&] { return to_string(prefix.size()) + "-byte prefix, nonce " + to_string(nonce); };
+            log.expect("Sha256NonceHasher", shaHasher.hash(nonce) == sha256_digest(msg.data(), msg.size()),
+                       context);
+            uint32_t h = 0;
+            for (char ch : msg) h = (h * 101 + (uint32_t)(int)ch) % SIMPLE_HASH_MOD;
+            log.expect("SimpleHashNonceHasher", simpleHasher.value(nonce) == h, context);
+        }
+    }
+}
+
+void check_hex(CheckLog& log, Rule30Rng& rng, size_t cases) {
+    for (size_t c = 0; c < cases; ++c) {
+        size_t n = rng.below(100);
+        string bytes = random_bytes(rng, n);
+        bool upper = rng.below(2);
+        string expected;
+        char buf[3];
+        for (char b : bytes) {
+            snprintf(buf, sizeof(buf), upper ? "%02X" : "%02x", (unsigned)(uint8_t)b);
+            expected += buf;
+        }
+        string enc(2 * n, '\0');
+        hex_encode((const uint8_t*)bytes.data(), n, &enc[0], upper);
+        log.expect("hex_encode", enc == expected, [&] { return to_string(n) + " bytes"; });
+
+        vector<uint8_t> dec(n);
+        bool ok = hex_decode(expected.data(), n, dec.data()) &&
+                  equal(dec.begin(), dec.end(), (const uint8_t*)bytes.data());
+        if (n > 0) { // un caractère invalide doit être détecté
+            string bad = expected;
+            bad[rng.below(bad.size())] = "gG/:@`z "[rng.below(8)];
+            ok &= !hex_decode(bad.data(), n, dec.data());
+        }
+        log.expect("hex_decode", ok, [&] { return to_string(n) + " bytes"; });
+    }
+}
+
+// Éponge : le découpage des update() ne change rien ; arbre : le nombre de
+// threads ne change rien
+void check_sponge_tree(CheckLog& log, Rule30Rng& rng, size_t cases) {
+    for (size_t c = 0; c < cases; ++c) {
+        string msg = random_bytes(rng, rng.below(2000));
+        uint32_t rule = rng.below(2) ? 30 : (uint32_t)rng.below(256);
+        size_t rounds = 1 + rng.below(12);
+        AcSponge sponge(rule, rounds);
+        for (size_t at = 0; at < msg.size();) {
+            size_t take = min<size_t>(msg.size() - at, rng.below(80));
+            sponge.update(msg.data() + at, take);
+            at += take;
+        }
+        log.expect("AcSponge (chunked update)",
+                   sponge.finalize() == ac_sponge_hash(msg.data(), msg.size(), rule, rounds),
+                   [&] { return to_string(msg.size()) + " bytes, rule " + to_string(rule); });
+    }
+    for (size_t leaves : {0, 1, 2, 3, 5}) {
+        string msg = random_bytes(rng, leaves * AC_TREE_LEAF_BYTES + rng.below(1000));
+        log.expect("ac_tree_hash (1 vs 4 threads)",
+                   ac_tree_hash(msg, 30, 8, 1) == ac_tree_hash(msg, 30, 8, 4),
+                   [&] { return to_string(msg.size()) + " bytes"; });
+    }
+}
+
+void check_2d(CheckLog& log, Rule30Rng& rng, size_t cases) {
+    for (size_t c = 0; c < cases; ++c) {
+        // grandes grilles (c impair) : au-delà d'AC2D_TILE_BYTES, par bandes
+        bool large = c % 2;
+        size_t width = 64 * (1 + rng.below(large ? 8 : 3));
+        size_t height = large ? AC2D_TILE_BYTES / 8 / (width / 64 + 2) + 1 + rng.below(300)
+                              : 1 + rng.below(40);
+        size_t steps = large ? 1 + rng.below(12) : random_steps(rng) % 40;
+        uint32_t rule = rng.below(2) ? ac2d_rule(AC2D_DEFAULT_RULE) : (uint32_t)rng() & 0x1FF01FF;
+        Grid2D g(width, height);
+        for (size_t r = 0; r < height; ++r)
+            for (size_t j = 0; j < g.nw; ++j) g.row(r)[j] = rng();
+        Grid2D expected = reference_evolve_2d(g, rule, steps);
+        evolve_2d(g, rule, steps);
+        auto context = [&] {
+            ostringstream o;
+            o << width << "x" << height << ", rule 0x" << hex << rule << dec << ", steps " << steps;
+            return o.str();
+        };
+        bool same = true;
+        for (size_t r = 0; r < height; ++r)
+            same &= memcmp(g.row(r), expected.row(r), g.nw * 8) == 0;
+        log.expect(large ? "evolve_2d (banded)" : "evolve_2d", same, context);
+        log.expect("ac2d_to_digest", ac2d_to_digest(g) == reference_2d_digest(expected), context);
+    }
+}
+
+void check_rng(CheckLog& log, Rule30Rng& rng, size_t cases) {
+#if AC_ENGINE_X86
+    if (!cpu_supports_isa(ISA_AVX2)) return;
+    const size_t planeWords = (AC_RNG_CELLS + 2) * AC_RNG_PLANE_WORDS;
+    const size_t outWords = AC_RNG_BLOCK_STEPS * AC_RNG_PLANE_WORDS;
+    for (size_t c = 0; c < cases; ++c) {
+        vector<uint64_t> a(planeWords), b(planeWords), a2(planeWords), b2(planeWords);
+        for (uint64_t& w : a) w = rng();
+        b = a;
+        vector<uint64_t> outA(outWords), outB(outWords);
+        uint64_t* ra = ac_rng_block_sse(a.data(), a2.data(), outA.data());
+        uint64_t* rb = ac_rng_block_avx2(b.data(), b2.data(), outB.data());
+        bool same = outA == outB;
+        const size_t from = AC_RNG_PLANE_WORDS, to = (AC_RNG_CELLS + 1) * AC_RNG_PLANE_WORDS;
+        same &= equal(ra + from, ra + to, rb + from);
+        log.expect("Rule30Rng (avx2 vs sse)", same, [&] { return "case " + to_string(c); });
+    }
+#else
+    (void)log; (void)rng; (void)cases;
+#endif
+}
+
+// ===========================================================
+// ================ DÉBITS ET RÉFÉRENCE ======================
+// ===========================================================
+
+struct BenchEntry {
+    string name, unit;
+    double value;
+};
+
+const int BENCH_RETRIES = 2;          // nouvelles mesures avant de conclure à une régression
+const int BENCH_REPS = 3;             // fenêtres par mesure (on garde la meilleure)
+const double BENCH_WINDOW_SECONDS = 0.2;
+const int BASELINE_SAMPLES = 10;      // --update-baseline : mesures par débit...
+const double BASELINE_PERCENTILE = 0.2; // ... dont on enregistre ce percentile bas
+
+volatile uint8_t bench_sink;
+
+// Meilleur débit sur `reps` mesures d'au moins minSeconds chacune ;
+// op() renvoie la quantité traitée par appel
+template <class Op>
+double best_rate(Op op, int reps = BENCH_REPS, double minSeconds = BENCH_WINDOW_SECONDS) {
+    double best = 0;
+    for (int r = 0; r < reps; ++r) {
+        double units = 0, elapsed = 0;
+        auto start = chrono::steady_clock::now();
+        do {
+            units += op();
+            elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        } while (elapsed < minSeconds);
+        best = max(best, units / elapsed);
+    }
+    return best;
+}
+
+// Les mesures de débit ; chacune peut être relancée seule (mesure bruitée)
+class Benchmarks {
+public:
+    struct Spec {
+        string name, unit;
+        function<double()> measure;
+    };
+
+    // Hacheur et sonde AC sur un préfixe de 12 octets : 96 bits < m + steps
+    // = 112, le nonce est dans le cône de lumière des 12 premiers bits (sur
+    // l'en-tête complet, la sonde ne renverrait que son résultat constant)
+    Benchmarks() : rng_(7), msg64_(random_bytes(rng_, 64)),
+                   prefix_("7" + string(64, 'A') + "1700000000" + msg64_),
+                   acPrefix_(msg64_.substr(0, 12)),
+                   acHasher_(acPrefix_, 30, 100), probe_(acPrefix_, 30, 100, 12),
+                   shaHasher_(prefix_), simpleHasher_(prefix_),
+                   s1024_(pack_cells(random_cells(rng_, 1024))),
+                   s4096_(pack_cells(random_cells(rng_, 4096))),
+                   mb_(random_bytes(rng_, 1 << 20)), words_(1 << 14) {
+        assert(probe_.depends_on_nonce());
+        add("evolve_packed_r30_1024x128", "Gcell-steps/s", [this] {
+            PackedState s = s1024_;
+            evolve_packed(s, 30, 128);
+            bench_sink = (uint8_t)s.buf[1];
+            return 1024.0 * 128 / 1e9;
+        });
+        add("evolve_packed_r90_4096x1024", "Gcell-steps/s", [this] {
+            PackedState s = s4096_;
+            evolve_packed(s, 90, 1024, PERIODIC_BOUNDARY);
+            bench_sink = (uint8_t)s.buf[1];
+            return 4096.0 * 1024 / 1e9;
+        });
+        add("ac_hash_64B_r30_100", "Khash/s", [this] {
+            PackedState s = pack_bytes(msg64_.data(), msg64_.size());
+            evolve_packed(s, 30, 100);
+            bench_sink = packed_to_digest(s, 256)[0];
+            return 1e-3;
+        });
+        add("ac_nonce_hasher_r30_100", "Khash/s", [this] {
+            bench_sink = acHasher_.hash(++nonce_)[0];
+            return 1e-3;
+        });
+        add("ac_bitsliced_probe_r30_100", "Mnonce/s", [this] {
+            for (int k = 0; k < 64; ++k) bench_sink = (uint8_t)probe_.passes(++nonce_);
+            return 64e-6;
+        });
+        add("sha256_nonce_hasher", "Mhash/s", [this] {
+            for (int k = 0; k < 64; ++k) bench_sink = shaHasher_.hash(++nonce_)[0];
+            return 64e-6;
+        });
+        add("simple_nonce_hasher", "Mhash/s", [this] {
+            for (int k = 0; k < 64; ++k) bench_sink = (uint8_t)simpleHasher_.value(++nonce_);
+            return 64e-6;
+        });
+        add("ac_sponge_1MB", "MB/s", [this] {
+            bench_sink = ac_sponge_hash(mb_.data(), mb_.size())[0];
+            return 1.0;
+        });
+        add("ac2d_hash_64B", "Khash/s", [this] {
+            bench_sink = ac2d_hash(msg64_)[0];
+            return 1e-3;
+        });
+        add("rule30_rng", "MB/s", [this] {
+            rng_.fill(words_.data(), words_.size());
+            bench_sink = (uint8_t)words_[0];
+            return words_.size() * 8 / 1e6;
+        });
+    }
+
+    const vector<Spec>& specs() const { return specs_; }
+
+private:
+    template <class Op>
+    void add(const string& name, const string& unit, Op op) {
+        specs_.push_back({name, unit, [op] { return best_rate(op); }});
+    }
+
+    Rule30Rng rng_;
+    string msg64_, prefix_, acPrefix_;
+    AcNonceHasher acHasher_;
+    AcBitslicedProbe probe_;
+    Sha256NonceHasher shaHasher_;
+    SimpleHashNonceHasher simpleHasher_;
+    PackedState s1024_, s4096_;
+    string mb_;
+    vector<uint64_t> words_;
+    int64_t nonce_ = 0;
+    vector<Spec> specs_;
+};
+
+// Valeur d'un champ "clé : valeur" de /proc/cpuinfo (Linux), "" sinon
+string cpuinfo_field(const string& key) {
+    ifstream info("/proc/cpuinfo");
+    for (string line; getline(info, line);) {
+        size_t colon = line.find(':');
+        if (colon == string::npos) continue;
+        string k = line.substr(0, colon);
+        k.erase(k.find_last_not_of(" \t") + 1);
+        if (k != key) continue;
+        size_t v = line.find_first_not_of(" \t", colon + 1);
+        return v == string::npos ? "" : line.substr(v);
+    }
+    return "";
+}
+
+// Identité de la machine pour les débits. Le nom du modèle ne suffit pas : un
+// processeur virtualisé s'annonce souvent "Intel(R) Xeon(R) Processor". On y
+// ajoute famille/modèle/stepping, la fréquence (max de cpufreq, sinon "cpu
+// MHz" arrondi à 100 MHz), le nombre de cœurs logiques, puis le noyau AC et
+// SHA-256 choisis. Windows : PROCESSOR_IDENTIFIER donne famille et modèle.
+string machine_id() {
+    string cpu = cpuinfo_field("model name");
+    if (!cpu.empty())
+        cpu += " (family " + cpuinfo_field("cpu family") + ", model " + cpuinfo_field("model") +
+               ", stepping " + cpuinfo_field("stepping") + ")";
+    if (cpu.empty() && getenv("PROCESSOR_IDENTIFIER")) cpu = getenv("PROCESSOR_IDENTIFIER");
+    if (cpu.empty()) cpu = "unknown cpu";
+
+    long mhz = 0;
+    ifstream maxFreq("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq");
+    long khz = 0;
+    if (maxFreq >> khz) mhz = khz / 1000;
+    else if (!cpuinfo_field("cpu MHz").empty()) mhz = lround(stod(cpuinfo_field("cpu MHz")) / 100) * 100;
+
+    return cpu + " | " + (mhz ? to_string(mhz) + " MHz" : string("? MHz")) + " | " +
+           to_string(default_mining_threads()) + " threads | isa " +
+           kernel_isa_name(best_kernel_isa()) + " | sha256 " + sha256_impl_name(sha256_batch_impl());
+}
+
+// Mesure chaque débit ; une mesure sous le seuil est refaite jusqu'à
+// BENCH_RETRIES fois (on garde la meilleure) avant d'être retenue.
+// recording : référence à enregistrer, percentile bas (BASELINE_PERCENTILE)
+// de BASELINE_SAMPLES mesures : une référence prise sur une mesure favorable
+// ferait échouer le garde-fou au moindre bruit de la machine
+vector<BenchEntry> run_benchmarks(const map<string, double>& base, double threshold,
+                                  bool recording = false) {
+    Benchmarks benchmarks;
+    vector<BenchEntry> out;
+    for (const Benchmarks::Spec& spec : benchmarks.specs()) {
+        if (recording) {
+            vector<double> samples;
+            for (int k = 0; k < BASELINE_SAMPLES; ++k) samples.push_back(spec.measure());
+            sort(samples.begin(), samples.end());
+            size_t rank = max<size_t>(1, (size_t)ceil(BASELINE_PERCENTILE * BASELINE_SAMPLES));
+            out.push_back({spec.name, spec.unit, samples[rank - 1]});
+            continue;
+        }
+        double value = spec.measure();
+        auto it = base.find(spec.name);
+        for (int r = 0; r < BENCH_RETRIES && it != base.end() && value < it->second * (1 - threshold); ++r)
+            value = max(value, spec.measure());
+        out.push_back({spec.name, spec.unit, value});
+    }
+    return out;
+}
+
+// Fichier de référence : une ligne "machine <identité>" ouvre une section,
+// suivie de lignes "nom valeur unité". Machine -> nom -> débit.
+typedef map<string, map<string, double>> Baseline;
+const char* BASELINE_MACHINE = "machine ";
+
+Baseline load_baseline(const string& path) {
+    Baseline base;
+    ifstream in(path);
+    string line, machine;
+    while (getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        if (line.compare(0, strlen(BASELINE_MACHINE), BASELINE_MACHINE) == 0) {
+            machine = line.substr(strlen(BASELINE_MACHINE));
+            continue;
+        }
+        istringstream ss(line);
+        string name;
+        double value;
+        if (ss >> name >> value) base[machine][name] = value;
+    }
+    return base;
+}
+
+// Réécrit la section de `machine` ; celles des autres machines sont gardées
+bool save_baseline(const string& path, const string& machine, const vector<BenchEntry>& entries) {
+    Baseline base = load_baseline(path);
+    map<string, string> units;
+    for (const BenchEntry& e : entries) units[e.name] = e.unit;
+    base[machine].clear();
+    for (const BenchEntry& e : entries) base[machine][e.name] = e.value;
+
+    ofstream out(path);
+    out << "# Débits de référence de regression.cpp (nom valeur unité), plus grand = meilleur.\n"
+        << "# Une section par machine ; regression --update-baseline remplace celle de la\n"
+        << "# machine courante par ses mesures.\n";
+    out << fixed << setprecision(3);
+    for (const auto& section : base) {
+        if (section.first.empty()) continue; // ancien format, sans machine : non comparable
+        out << BASELINE_MACHINE << section.first << "\n";
+        for (const auto& kv : section.second)
+            out << kv.first << " " << kv.second << " "
+                << (units.count(kv.first) ? units[kv.first] : string("?")) << "\n";
+    }
+    return (bool)out;
+}
+
+// Compare aux références de la machine courante ; renvoie false si un débit
+// a trop baissé ou manque. comparable = false : références d'une autre
+// machine, affichées sans être comparées au seuil (échec)
+bool compare_baseline(const vector<BenchEntry>& entries, const map<string, double>& base,
+                      double threshold, bool comparable = true) {
+    bool ok = comparable;
+    cout << left << setw(30) << "Benchmark" << right << setw(14) << "Measured" << setw(14)
+         << "Baseline" << setw(9) << "Ratio" << "  Unit\n";
+    cout << string(84, '-') << "\n";
+    for (const BenchEntry& e : entries) {
+        auto it = base.find(e.name);
+        cout << left << setw(30) << e.name << right << fixed << setprecision(2) << setw(14) << e.value;
+        if (it == base.end() || it->second <= 0) {
+            ok = false;
+            cout << setw(14) << "-" << setw(9) << "-" << "  " << e.unit << "  MISSING FROM BASELINE\n";
+            continue;
+        }
+        if (!comparable) {
+            cout << setw(14) << it->second << setw(9) << "-" << "  " << e.unit << "  not comparable\n";
+            continue;
+        }
+        double ratio = e.value / it->second;
+        bool pass = ratio >= 1 - threshold;
+        ok &= pass;
+        cout << setw(14) << it->second << setw(9) << ratio << "  " << e.unit
+             << (pass ? "" : "  REGRESSION") << "\n";
+    }
+    return ok;
+}
+
+// ===========================================================
+// ======================= MAIN ==============================
+// ===========================================================
+
+int main(int argc, char** argv) {
+    uint64_t seed = 1;
+    size_t cases = 4;
+    string baselinePath = "regression_baseline.txt";
+    double threshold = 0.25;
+    bool update = false, bench = true;
+    for (int i = 1; i < argc; ++i) {
+        string key = argv[i];
+        if (key == "--update-baseline") update = true;
+        else if (key == "--no-bench") bench = false;
+        else if (i + 1 < argc && key == "--seed") seed = stoull(argv[++i]);
+        else if (i + 1 < argc && key == "--cases") cases = max<size_t>(1, stoull(argv[++i]));
+        else if (i + 1 < argc && key == "--baseline") baselinePath = argv[++i];
+        else if (i + 1 < argc && key == "--threshold") threshold = stod(argv[++i]);
+        else {
+            cerr << "Unknown option " << key << "\n";
+            return 2;
+        }
+    }
+
+    cout << "=== Differential tests (seed " << seed << ", kernel ISA "
+         << kernel_isa_name(best_kernel_isa()) << ", SHA-256 "
+         << sha256_impl_name(sha256_batch_impl()) << ") ===\n";
+    auto start = chrono::steady_clock::now();
+    CheckLog log;
+    Rule30Rng rng(seed);
+    check_radius1(log, rng, cases);
+    check_radius2(log, rng, 64 * cases);
+    check_ac_hash(log, rng, 64 * cases);
+    check_ac_mining(log, rng, 8 * cases);
+    check_sha256(log, rng, 32 * cases);
+    check_hex(log, rng, 256 * cases);
+    check_sponge_tree(log, rng, 32 * cases);
+    check_2d(log, rng, 4 * cases);
+    check_rng(log, rng, 16 * cases);
+    bool ok = log.print();
+    cout << "(" << fixed << setprecision(1)
+         << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s)\n";
+
+    if (bench) {
+        cout << "\n=== Throughput vs baseline (" << baselinePath << ", threshold -"
+             << setprecision(0) << threshold * 100 << "%) ===\n";
+        string machine = machine_id();
+        cout << "Machine: " << machine << "\n";
+        Baseline all = update ? Baseline() : load_baseline(baselinePath);
+        auto own = all.find(machine);
+        vector<BenchEntry> entries =
+            run_benchmarks(own != all.end() ? own->second : map<string, double>(), threshold, update);
+        if (update) {
+            if (!save_baseline(baselinePath, machine, entries)) {
+                cerr << "Could not write " << baselinePath << "\n";
+                return 1;
+            }
+            for (const BenchEntry& e : entries)
+                cout << left << setw(30) << e.name << right << fixed << setprecision(2) << setw(14)
+                     << e.value << "  " << e.unit << "\n";
+            cout << "Baseline updated for this machine.\n";
+        } else if (all.empty()) {
+            cout << "No baseline found in " << baselinePath
+                 << ": run with --update-baseline to record one for this machine.\n";
+            ok = false;
+        } else if (own == all.end()) {
+            const string& other = all.begin()->first;
+            cout << "No baseline for this machine; numbers below were recorded on \""
+                 << (other.empty() ? "an unidentified machine" : other)
+                 << "\" and are not comparable.\nRun with --update-baseline to record one for "
+                 << "this machine.\n";
+            ok &= compare_baseline(entries, all.begin()->second, threshold, false);
+        } else {
+            ok &= compare_baseline(entries, own->second, threshold);
+        }
+    }
+
+    cout << "\nRESULT: " << (ok ? "PASS" : "FAIL") << "\n";
+    return ok ? 0 : 1;
+}
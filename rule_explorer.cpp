@@ -0,0 +1,463 @@
+// rule_explorer.cpp
+// Exploration de l'espace des paramètres d'AC_HASH : les 256 règles
+// élémentaires, plusieurs nombres de générations et les deux bords.
+//
+// Le hash étudié est celui des blocs (exercice3, lastexercise) :
+// pack_bytes, evolve_packed(rule, steps, boundary), 256 premières cellules.
+// Pour chaque configuration, sur des messages aléatoires de --bytes octets
+// (Rule30Rng, flux propre à la configuration) :
+//   - avalanche : part des bits de sortie changés quand un bit d'entrée
+//     tiré au hasard est inversé (idéal 50 %) ;
+//   - biais : max sur les 256 bits de sortie de |P(bit = 1) - 1/2| ;
+//   - déterminisme : deux calculs, et le chemin rapide (noyaux spécialisés,
+//     avance rapide des règles linéaires) comparé au noyau générique scalaire ;
+//   - débit : hashes par seconde sur un thread, pour les configurations
+//     qualifiées seulement (voir plus bas).
+// Une première passe de PRUNE_SAMPLES essais écarte les configurations
+// manifestement faibles ; les autres sont mesurées sur --samples essais.
+// Les mesures de qualité sont gardées dans un fichier cache (CSV) : une
+// nouvelle exécution ne calcule que les configurations absentes.
+// Le débit n'est jamais pris dans le cache ni mesuré pendant le balayage
+// parallèle : après celui-ci, chaque configuration qualifiée est chronométrée
+// seule, --timing-runs fois, et l'on garde la médiane. Deux débits dont
+// l'écart reste dans le bruit de mesure sont à égalité, départagée par
+// l'écart à l'idéal (avalanche, biais).
+//
+// Compilation : g++ -O2 -std=c++17 -pthread rule_explorer.cpp -o rule_explorer
+// Usage : rule_explorer [--steps 32,64,128,256,512] [--boundary zero,periodic]
+//                       [--bytes 64] [--samples 1024] [--seed 1] [--threads 0]
+//                       [--cache rule_explorer_cache.csv] [--out rule_ranking.csv]
+//                       [--top 20] [--timing-runs 7]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ac_engine.h"
+#include "ac_rng.h"
+#include "ac_tree.h"
+#include "digest.h"
+using namespace std;
+
+const int CACHE_VERSION = 2;          // à changer si le hash ou les mesures changent
+const size_t PRUNE_SAMPLES = 64;
+const double PRUNE_AVALANCHE = 0.25;  // avalanche hors de [0.25, 0.75] : écartée
+const double PRUNE_BIAS = 0.35;       // bit de sortie presque constant : écartée
+const size_t DETERMINISM_SAMPLES = 4;
+const double TIMING_SECONDS = 0.02;   // durée minimale d'une mesure de débit
+const double TIMING_NOISE_FLOOR = 0.03; // écart relatif de débit toujours considéré comme du bruit
+
+struct ExplorerConfig {
+    uint32_t rule;
+    size_t steps;
+    Boundary boundary;
+};
+
+struct ExplorerResult {
+    ExplorerConfig cfg;
+    size_t samples = 0;       // essais réellement faits (PRUNE_SAMPLES si écartée)
+    bool pruned = false;
+    bool deterministic = true;
+    double avalanche = 0;     // fraction moyenne de bits changés
+    double avalancheStd = 0;  // écart-type par essai
+    double bias = 0;          // max |P(bit = 1) - 1/2|
+    double hashesPerSec = 0;  // médiane des mesures (qualifiées seulement, hors cache)
+    double timingNoise = 0;   // demi-étendue relative des mesures de débit
+};
+
+struct ExplorerOptions {
+    vector<size_t> steps = {32, 64, 128, 256, 512};
+    vector<Boundary> boundaries = {ZERO_BOUNDARY, PERIODIC_BOUNDARY};
+    size_t bytes = 64;
+    size_t samples = 1024;
+    uint64_t seed = 1;
+    unsigned threads = 0;
+    string cache = "rule_explorer_cache.csv";
+    string out = "rule_ranking.csv";
+    size_t top = 20;
+    size_t timingRuns = 7;
+};
+
+const char* boundary_name(Boundary b) { return b == ZERO_BOUNDARY ? "zero" : "periodic"; }
+
+// ===========================================================
+// ===================== MESURES =============================
+// ===========================================================
+
+Digest explorer_hash(const char* data, size_t len, const ExplorerConfig& c,
+                     bool reference = false) {
+    PackedState state = pack_bytes(data, len);
+    if (reference)
+        evolve_packed_generic(state, c.rule, c.steps, c.boundary, ISA_SCALAR);
+    else
+        evolve_packed(state, c.rule, c.steps, c.boundary);
+    return packed_to_digest(state, 256);
+}
+
+// Avalanche et biais sur `samples` essais, à la suite de ceux déjà cumulés
+struct QualityCounters {
+    size_t samples = 0;
+    double flipSum = 0, flipSq = 0;
+    vector<uint32_t> ones = vector<uint32_t>(256, 0);
+
+    void run(const ExplorerConfig& c, size_t bytes, size_t count, Rule30Rng& rng) {
+        vector<char> msg(bytes);
+        for (size_t s = 0; s < count; ++s) {
+            for (char& b : msg) b = (char)rng();
+            Digest h0 = explorer_hash(msg.data(), bytes, c);
+            size_t bit = rng.below(8 * bytes);
+            msg[bit / 8] ^= (char)(0x80 >> (bit % 8));
+            Digest h1 = explorer_hash(msg.data(), bytes, c);
+            double f = digest_hamming(h0, h1) / 256.0;
+            flipSum += f;
+            flipSq += f * f;
+            for (size_t j = 0; j < 256; ++j) ones[j] += h0.bit(j);
+        }
+        samples += count;
+    }
+
+    void store(ExplorerResult& r) const {
+        double n = (double)samples;
+        r.samples = samples;
+        r.avalanche = flipSum / n;
+        r.avalancheStd = sqrt(max(0.0, flipSq / n - r.avalanche * r.avalanche));
+        r.bias = 0;
+        for (uint32_t o : ones) r.bias = max(r.bias, fabs(o / n - 0.5));
+    }
+};
+
+double measure_throughput(const ExplorerConfig& c, size_t bytes, Rule30Rng& rng) {
+    vector<char> msg(bytes);
+    for (char& b : msg) b = (char)rng();
+    size_t count = 0;
+    auto start = chrono::steady_clock::now();
+    double elapsed = 0;
+    uint8_t sink = 0;
+    do {
+        for (int k = 0; k < 16; ++k, ++count) {
+            msg[count % bytes] ^= 1;
+            sink ^= explorer_hash(msg.data(), bytes, c)[0];
+        }
+        elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    } while (elapsed < TIMING_SECONDS);
+    msg[0] ^= (char)sink; // garde le calcul vivant
+    return count / elapsed;
+}
+
+// Débit d'une configuration chronométrée seule : médiane de `runs` mesures,
+// et demi-étendue relative comme estimation du bruit
+void time_configuration(ExplorerResult& r, const ExplorerOptions& opt) {
+    Rule30Rng rng(opt.seed, 0x7431u ^ r.cfg.rule);
+    vector<double> runs;
+    for (size_t k = 0; k < opt.timingRuns; ++k) runs.push_back(measure_throughput(r.cfg, opt.bytes, rng));
+    sort(runs.begin(), runs.end());
+    r.hashesPerSec = runs[runs.size() / 2];
+    r.timingNoise = (runs.back() - runs.front()) / (2 * r.hashesPerSec);
+}
+
+ExplorerResult explore(const ExplorerConfig& c, const ExplorerOptions& opt) {
+    ExplorerResult r;
+    r.cfg = c;
+    // flux propre à la configuration : résultat indépendant de l'ordre
+    Rule30Rng rng(opt.seed, ((uint64_t)c.rule << 32) | (c.steps << 1) | (uint64_t)c.boundary);
+
+    vector<char> msg(opt.bytes);
+    for (size_t s = 0; s < DETERMINISM_SAMPLES && r.deterministic; ++s) {
+        for (char& b : msg) b = (char)rng();
+        Digest a = explorer_hash(msg.data(), opt.bytes, c);
+        r.deterministic = a == explorer_hash(msg.data(), opt.bytes, c) &&
+                          a == explorer_hash(msg.data(), opt.bytes, c, true);
+    }
+
+    QualityCounters q;
+    q.run(c, opt.bytes, min(PRUNE_SAMPLES, opt.samples), rng);
+    q.store(r);
+    r.pruned = !r.deterministic || r.avalanche < PRUNE_AVALANCHE ||
+               r.avalanche > 1 - PRUNE_AVALANCHE || r.bias > PRUNE_BIAS;
+    if (r.pruned) return r;
+
+    if (opt.samples > q.samples) q.run(c, opt.bytes, opt.samples - q.samples, rng);
+    q.store(r);
+    return r;
+}
+
+// ===========================================================
+// ====================== CACHE ==============================
+// ===========================================================
+
+// Clé : tout ce dont dépend le résultat
+string cache_key(const ExplorerConfig& c, const ExplorerOptions& opt) {
+    ostringstream k;
+    k << CACHE_VERSION << ";" << c.rule << ";" << c.steps << ";" << boundary_name(c.boundary)
+      << ";" << opt.bytes << ";" << opt.samples << ";" << opt.seed;
+    return k.str();
+}
+
+const char* CACHE_HEADER =
+    "key,rule,steps,boundary,samples,pruned,deterministic,avalanche,avalanche_std,bias";
+
+void write_result(ostream& out, const string& key, const ExplorerResult& r) {
+    out << key << "," << r.cfg.rule << "," << r.cfg.steps << "," << boundary_name(r.cfg.boundary)
+        << "," << r.samples << "," << r.pruned << "," << r.deterministic << ","
+        << setprecision(8) << r.avalanche << "," << r.avalancheStd << "," << r.bias;
+}
+
+map<string, ExplorerResult> load_cache(const string& path) {
+    map<string, ExplorerResult> cache;
+    ifstream in(path);
+    string line;
+    if (!getline(in, line) || line != CACHE_HEADER) return cache;
+    while (getline(in, line)) {
+        vector<string> f;
+        stringstream ss(line);
+        for (string cell; getline(ss, cell, ',');) f.push_back(cell);
+        if (f.size() != 10) continue;
+        ExplorerResult r;
+        r.cfg = {(uint32_t)stoul(f[1]), (size_t)stoull(f[2]),
+                 f[3] == "zero" ? ZERO_BOUNDARY : PERIODIC_BOUNDARY};
+        r.samples = stoull(f[4]);
+        r.pruned = f[5] == "1";
+        r.deterministic = f[6] == "1";
+        r.avalanche = stod(f[7]);
+        r.avalancheStd = stod(f[8]);
+        r.bias = stod(f[9]);
+        cache[f[0]] = r;
+    }
+    return cache;
+}
+
+bool save_cache(const string& path, const map<string, ExplorerResult>& cache) {
+    ofstream out(path);
+    out << CACHE_HEADER << "\n";
+    for (const auto& kv : cache) {
+        write_result(out, kv.first, kv.second);
+        out << "\n";
+    }
+    return (bool)out;
+}
+
+// ===========================================================
+// ===================== CLASSEMENT ==========================
+// ===========================================================
+
+// Qualifiée : déterministe, non écartée, avalanche et biais dans le bruit
+// d'échantillonnage attendu d'une fonction aléatoire (4 écarts-types)
+bool qualified(const ExplorerResult& r) {
+    if (r.pruned || !r.deterministic) return false;
+    double n = (double)r.samples;
+    double avalancheTol = 4 * sqrt(0.25 / 256 / n);
+    // max de 256 écarts |p - 1/2| d'écart-type 0.5 / sqrt(n)
+    double biasTol = 4 * 0.5 / sqrt(n);
+    return fabs(r.avalanche - 0.5) <= avalancheTol && r.bias <= biasTol;
+}
+
+// Écart à l'idéal, pour ordonner les configurations non qualifiées
+double quality_error(const ExplorerResult& r) {
+    return fabs(r.avalanche - 0.5) + r.bias + (r.deterministic ? 0 : 1);
+}
+
+// Paliers de débit des configurations qualifiées : par débit décroissant,
+// une configuration rejoint le palier en cours si son écart au meneur du
+// palier reste dans le bruit des deux mesures (au moins TIMING_NOISE_FLOOR)
+vector<size_t> throughput_tiers(const vector<ExplorerResult>& results) {
+    vector<size_t> order;
+    for (size_t i = 0; i < results.size(); ++i)
+        if (qualified(results[i])) order.push_back(i);
+    sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return results[a].hashesPerSec > results[b].hashesPerSec;
+    });
+    vector<size_t> tier(results.size(), 0);
+    size_t current = 0, leader = 0;
+    for (size_t k = 0; k < order.size(); ++k) {
+        const ExplorerResult& r = results[order[k]];
+        const ExplorerResult& lead = results[order[leader]];
+        double noise = max(TIMING_NOISE_FLOOR, lead.timingNoise + r.timingNoise);
+        if (r.hashesPerSec < lead.hashesPerSec * (1 - noise)) {
+            ++current;
+            leader = k;
+        }
+        tier[order[k]] = current;
+    }
+    return tier;
+}
+
+// Les qualifiées d'abord, par palier de débit puis écart à l'idéal ; puis les
+// autres, par écart à l'idéal
+struct RankOrder {
+    const vector<ExplorerResult>& results;
+    const vector<size_t>& tier;
+
+    bool operator()(size_t a, size_t b) const {
+        const ExplorerResult& ra = results[a];
+        const ExplorerResult& rb = results[b];
+        bool qa = qualified(ra), qb = qualified(rb);
+        if (qa != qb) return qa;
+        if (qa && tier[a] != tier[b]) return tier[a] < tier[b];
+        if (!qa && ra.pruned != rb.pruned) return !ra.pruned;
+        return quality_error(ra) < quality_error(rb);
+    }
+};
+
+string status(const ExplorerResult& r) {
+    if (!r.deterministic) return "NON-DETERMINISTIC";
+    if (r.pruned) return "pruned";
+    return qualified(r) ? "qualified" : "weak";
+}
+
+void print_table(const vector<ExplorerResult>& ranked, size_t top) {
+    cout << left << setw(6) << "Rank" << setw(6) << "Rule" << setw(7) << "Steps" << setw(10)
+         << "Boundary" << right << setw(11) << "Avalanche" << setw(9) << "Std" << setw(9)
+         << "Bias" << setw(13) << "Khash/s" << setw(8) << "Noise" << "  " << left << "Status\n";
+    cout << string(88, '-') << "\n";
+    for (size_t i = 0; i < min(top, ranked.size()); ++i) {
+        const ExplorerResult& r = ranked[i];
+        cout << left << setw(6) << i + 1 << setw(6) << r.cfg.rule << setw(7) << r.cfg.steps
+             << setw(10) << boundary_name(r.cfg.boundary) << right << fixed << setprecision(2)
+             << setw(10) << 100 * r.avalanche << "%" << setprecision(2) << setw(8)
+             << 100 * r.avalancheStd << "%" << setprecision(4) << setw(9) << r.bias
+             << setprecision(1);
+        if (r.hashesPerSec > 0)
+            cout << setw(13) << r.hashesPerSec / 1e3 << setw(7) << 100 * r.timingNoise << "%";
+        else
+            cout << setw(13) << "-" << setw(8) << "-";
+        cout << "  " << left << status(r) << "\n";
+    }
+}
+
+// ===========================================================
+// ======================= MAIN ==============================
+// ===========================================================
+
+vector<string> split_list(const string& s) {
+    vector<string> out;
+    stringstream ss(s);
+    for (string item; getline(ss, item, ',');)
+        if (!item.empty()) out.push_back(item);
+    return out;
+}
+
+bool parse_options(int argc, char** argv, ExplorerOptions& opt) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string key = argv[i], value = argv[i + 1];
+        if (key == "--steps") {
+            opt.steps.clear();
+            for (const string& s : split_list(value)) opt.steps.push_back(stoull(s));
+        } else if (key == "--boundary") {
+            opt.boundaries.clear();
+            for (const string& b : split_list(value))
+                opt.boundaries.push_back(b == "zero" ? ZERO_BOUNDARY : PERIODIC_BOUNDARY);
+        } else if (key == "--bytes") opt.bytes = max<size_t>(32, stoull(value));
+        else if (key == "--samples") opt.samples = max<size_t>(1, stoull(value));
+        else if (key == "--seed") opt.seed = stoull(value);
+        else if (key == "--threads") opt.threads = (unsigned)stoul(value);
+        else if (key == "--cache") opt.cache = value;
+        else if (key == "--out") opt.out = value;
+        else if (key == "--top") opt.top = stoull(value);
+        else if (key == "--timing-runs") opt.timingRuns = max<size_t>(1, stoull(value));
+        else {
+            cerr << "Unknown option " << key << "\n";
+            return false;
+        }
+    }
+    if ((argc - 1) % 2) {
+        cerr << "Missing value for " << argv[argc - 1] << "\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    ExplorerOptions opt;
+    if (!parse_options(argc, argv, opt)) return 1;
+
+    vector<ExplorerConfig> configs;
+    for (size_t steps : opt.steps)
+        for (Boundary b : opt.boundaries)
+            for (uint32_t rule = 0; rule < 256; ++rule) configs.push_back({rule, steps, b});
+
+    map<string, ExplorerResult> cache = load_cache(opt.cache);
+    vector<ExplorerConfig> todo;
+    for (const ExplorerConfig& c : configs)
+        if (!cache.count(cache_key(c, opt))) todo.push_back(c);
+
+    cout << "=== AC_HASH rule-space exploration ===\n";
+    cout << configs.size() << " configurations (" << opt.bytes << "-byte messages, "
+         << opt.samples << " samples), " << configs.size() - todo.size() << " cached in "
+         << opt.cache << ", " << todo.size() << " to run on "
+         << (opt.threads ? opt.threads : default_mining_threads()) << " threads\n\n";
+
+    auto start = chrono::steady_clock::now();
+    vector<ExplorerResult> fresh(todo.size());
+    parallel_for_index(todo.size(), opt.threads, [&](size_t i) { fresh[i] = explore(todo[i], opt); });
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    for (size_t i = 0; i < todo.size(); ++i) cache[cache_key(todo[i], opt)] = fresh[i];
+    if (!todo.empty() && !save_cache(opt.cache, cache))
+        cerr << "Could not write " << opt.cache << "\n";
+
+    vector<ExplorerResult> results;
+    size_t pruned = 0;
+    for (const ExplorerConfig& c : configs) {
+        results.push_back(cache[cache_key(c, opt)]);
+        pruned += results.back().pruned;
+    }
+    size_t nQualified = count_if(results.begin(), results.end(), qualified);
+
+    cout << "Explored " << todo.size() << " configurations in " << fixed << setprecision(2)
+         << seconds << " s; " << pruned << " pruned early, " << nQualified << " qualified\n";
+
+    // débits : configurations qualifiées une à une, rien d'autre ne tourne
+    start = chrono::steady_clock::now();
+    for (ExplorerResult& r : results)
+        if (qualified(r)) time_configuration(r, opt);
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Timed " << nQualified << " qualified configurations alone (median of "
+         << opt.timingRuns << " runs) in " << seconds << " s\n\n";
+
+    vector<size_t> tier = throughput_tiers(results);
+    vector<size_t> order(results.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    stable_sort(order.begin(), order.end(), RankOrder{results, tier});
+    vector<ExplorerResult> ranked;
+    for (size_t i : order) ranked.push_back(results[i]);
+    print_table(ranked, opt.top);
+
+    ofstream out(opt.out);
+    out << "rank," << string(CACHE_HEADER).substr(4) << ",hashes_per_sec,timing_noise,status\n";
+    for (size_t i = 0; i < ranked.size(); ++i) {
+        out << i + 1;
+        write_result(out, "", ranked[i]);
+        out << "," << ranked[i].hashesPerSec << "," << ranked[i].timingNoise << ","
+            << status(ranked[i]) << "\n";
+    }
+    cout << "\nFull ranking written to " << opt.out << "\n";
+
+    if (nQualified) {
+        const ExplorerResult& best = ranked[0];
+        cout << "Recommendation: rule " << best.cfg.rule << ", " << best.cfg.steps << " steps, "
+             << boundary_name(best.cfg.boundary) << " boundary (fastest qualified tier, "
+             << "ties within timing noise broken by avalanche/bias error).\n";
+        // le hash des blocs (exercice3, lastexercise) fait évoluer avec ZERO_BOUNDARY
+        cout << "Note: the block hash uses the zero boundary";
+        auto zero = find_if(ranked.begin(), ranked.end(), [](const ExplorerResult& r) {
+            return qualified(r) && r.cfg.boundary == ZERO_BOUNDARY;
+        });
+        if (best.cfg.boundary == ZERO_BOUNDARY)
+            cout << ".\n";
+        else if (zero != ranked.end())
+            cout << "; best zero-boundary configuration: rule " << zero->cfg.rule << ", "
+                 << zero->cfg.steps << " steps.\n";
+        else
+            cout << "; no zero-boundary configuration qualified, so adopting this one "
+                 << "means switching the block hash to the periodic boundary.\n";
+    } else {
+        cout << "No configuration qualified: increase the step counts (--steps) or the sample size.\n";
+    }
+    return 0;
+}
@@ -9,4 +9,20 @@ if %errorlevel% neq 0 (
 echo Running tests...
 partie7.exe > test_results.txt
 echo Results saved in test_results.txt
+
+echo === Building regression ===
+g++ -O2 -std=c++17 -pthread regression.cpp -o regression.exe
+if %errorlevel% neq 0 (
+    echo Compilation failed!
+    pause
+    exit /b 1
+)
+echo Running differential tests and throughput gate...
+regression.exe > regression_results.txt
+if %errorlevel% neq 0 (
+    echo Regression gate failed ^(regression, or no baseline for this machine: regression.exe --update-baseline^). See regression_results.txt
+    pause
+    exit /b 1
+)
+echo Regression gate passed, details in regression_results.txt
 pause
@@ -0,0 +1,227 @@
+// sac.h
+// Critère d'avalanche strict (SAC) et indépendance des bits de sortie (BIC)
+// d'une fonction de hachage, sur tous les cœurs.
+//
+// Pour `trials` messages aléatoires de msgBytes octets et pour chaque bit
+// d'entrée i, on inverse le bit i et on compare les deux hashes :
+//   SAC : flips[i][j] = nombre d'essais où le bit de sortie j a changé ;
+//         idéalement trials / 2 pour tout (i, j) ;
+//   BIC : pour chaque i et chaque paire de sorties (j, k), corrélation entre
+//         les changements de j et de k sur les essais ; idéalement 0.
+// Les essais sont traités par lots de 64 : les 64 différences (Digest) sont
+// transposées en 256 mots, un par bit de sortie (bit s = essai s), et les
+// compteurs avancent de popcount(col[j]) et popcount(col[j] & col[k]).
+// Chaque thread traite des bits d'entrée entiers : les compteurs de paires
+// (256 x 256) restent locaux, sans synchronisation, et le résultat ne dépend
+// pas du nombre de threads. Les messages sont tirés de Rule30Rng(seed).
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "ac_rng.h"
+#include "ac_tree.h"
+#include "digest.h"
+
+const size_t SAC_OUT_BITS = 8 * DIGEST_BYTES;
+const size_t SAC_BATCH = 64;
+
+struct SacResult {
+    size_t inBits = 0, trials = 0;
+    std::vector<uint32_t> flips;   // inBits x SAC_OUT_BITS
+    std::vector<double> bicMax;    // par bit d'entrée : max |corrélation|
+    std::vector<double> bicMean;   // moyenne des |corrélation| définies
+    uint64_t bicUndefined = 0;     // paires dont un bit ne change jamais (ou toujours)
+
+    double probability(size_t in, size_t out) const {
+        return (double)flips[in * SAC_OUT_BITS + out] / (double)trials;
+    }
+
+    // Moyenne des flips / trials sur toute la matrice (effet avalanche moyen)
+    double mean_probability() const {
+        double s = 0;
+        for (uint32_t f : flips) s += f;
+        return s / ((double)trials * (double)flips.size());
+    }
+
+    // Plus grand écart |p - 1/2| de la matrice
+    double max_bias() const {
+        double m = 0;
+        for (uint32_t f : flips) m = std::max(m, std::fabs((double)f / (double)trials - 0.5));
+        return m;
+    }
+
+    // Part des cases dont l'écart à 1/2 dépasse `sigmas` écarts-types du
+    // bruit d'échantillonnage (0.5 / sqrt(trials))
+    double biased_fraction(double sigmas = 3.0) const {
+        double tol = sigmas * 0.5 / std::sqrt((double)trials);
+        size_t n = 0;
+        for (uint32_t f : flips) n += std::fabs((double)f / (double)trials - 0.5) > tol;
+        return (double)n / (double)flips.size();
+    }
+
+    double bic_max() const { return bicMax.empty() ? 0 : *std::max_element(bicMax.begin(), bicMax.end()); }
+};
+
+// Transposition d'une matrice 64 x 64 bits en place : le bit c de a[r]
+// passe au bit r de a[c] (échanges de blocs de 32, 16, ..., 1)
+inline void transpose64(uint64_t a[64]) {
+    uint64_t m = 0x00000000FFFFFFFFULL;
+    for (int j = 32; j != 0; j >>= 1, m ^= m << j) {
+        for (int k = 0; k < 64; k = (k + j + 1) & ~j) {
+            uint64_t t = ((a[k] >> j) ^ a[k + j]) & m;
+            a[k] ^= t << j;
+            a[k + j] ^= t;
+        }
+    }
+}
+
+// Compteurs de paires : pairs[j * 256 + k] += popcount(col[j] & col[k]), j < k
+inline void sac_count_pairs_generic(const uint64_t* col, uint32_t* pairs) {
+    for (size_t j = 0; j < SAC_OUT_BITS; ++j) {
+        uint64_t cj = col[j];
+        if (cj == 0) continue;
+        uint32_t* row = pairs + j * SAC_OUT_BITS;
+        for (size_t k = j + 1; k < SAC_OUT_BITS; ++k)
+            row[k] += (uint32_t)__builtin_popcountll(cj & col[k]);
+    }
+}
+
+#if AC_ENGINE_X86
+__attribute__((target("popcnt")))
+inline void sac_count_pairs_popcnt(const uint64_t* col, uint32_t* pairs) {
+    sac_count_pairs_generic(col, pairs);
+}
+#endif
+
+inline void sac_count_pairs(const uint64_t* col, uint32_t* pairs) {
+#if AC_ENGINE_X86
+    static const bool hasPopcnt = __builtin_cpu_supports("popcnt");
+    if (hasPopcnt) return sac_count_pairs_popcnt(col, pairs);
+#endif
+    sac_count_pairs_generic(col, pairs);
+}
+
+// hash(const char*, size_t) -> Digest, appelé en parallèle (doit être
+// réentrant). trials est arrondi au multiple de 64 supérieur.
+template <class Hash>
+SacResult sac_analyze(Hash hash, size_t msgBytes, size_t trials, uint64_t seed,
+                      unsigned threads = 0) {
+    SacResult res;
+    size_t batches = std::max<size_t>(1, (trials + SAC_BATCH - 1) / SAC_BATCH);
+    res.trials = batches * SAC_BATCH;
+    res.inBits = 8 * msgBytes;
+    res.flips.assign(res.inBits * SAC_OUT_BITS, 0);
+    res.bicMax.assign(res.inBits, 0);
+    res.bicMean.assign(res.inBits, 0);
+
+    // messages (tirés une fois, dans l'ordre : indépendants du nombre de
+    // threads) et leurs hashes
+    std::vector<char> msgs(res.trials * msgBytes);
+    {
+        Rule30Rng rng(seed);
+        for (char& c : msgs) c = (char)rng();
+    }
+    std::vector<Digest> base(res.trials);
+    parallel_for_index(batches, threads, [&](size_t b) {
+        for (size_t s = b * SAC_BATCH; s < (b + 1) * SAC_BATCH; ++s)
+            base[s] = hash(msgs.data() + s * msgBytes, msgBytes);
+    });
+
+    std::vector<uint64_t> undefined(res.inBits, 0);
+    parallel_for_index(res.inBits, threads, [&](size_t in) {
+        std::vector<uint32_t> pairs(SAC_OUT_BITS * SAC_OUT_BITS, 0);
+        std::vector<char> msg(msgBytes);
+        uint64_t col[SAC_OUT_BITS];
+        uint32_t* flips = res.flips.data() + in * SAC_OUT_BITS;
+        const char mask = (char)(0x80 >> (in % 8)); // MSB en premier
+
+        for (size_t b = 0; b < batches; ++b) {
+            // block[w][s] : mot w (gros-boutiste) de la différence de l'essai s
+            uint64_t block[DIGEST_WORDS][SAC_BATCH];
+            for (size_t s = 0; s < SAC_BATCH; ++s) {
+                size_t trial = b * SAC_BATCH + s;
+                std::memcpy(msg.data(), msgs.data() + trial * msgBytes, msgBytes);
+                msg[in / 8] ^= mask;
+                Digest h = hash(msg.data(), msgBytes);
+                for (size_t w = 0; w < DIGEST_WORDS; ++w)
+                    block[w][s] = h.word(w) ^ base[trial].word(w);
+            }
+            for (size_t w = 0; w < DIGEST_WORDS; ++w) {
+                transpose64(block[w]);
+                // bit de sortie 64w + o = bit 63 - o du mot w
+                for (size_t o = 0; o < 64; ++o) col[64 * w + o] = block[w][63 - o];
+            }
+            for (size_t j = 0; j < SAC_OUT_BITS; ++j)
+                flips[j] += (uint32_t)__builtin_popcountll(col[j]);
+            sac_count_pairs(col, pairs.data());
+        }
+
+        // corrélation de Pearson de deux indicateurs de changement
+        double n = (double)res.trials, maxCorr = 0, sumCorr = 0;
+        uint64_t defined = 0;
+        for (size_t j = 0; j < SAC_OUT_BITS; ++j) {
+            double a = flips[j];
+            for (size_t k = j + 1; k < SAC_OUT_BITS; ++k) {
+                double c = flips[k];
+                double den = a * (n - a) * c * (n - c);
+                if (den <= 0) {
+                    ++undefined[in];
+                    continue;
+                }
+                double r = std::fabs((n * pairs[j * SAC_OUT_BITS + k] - a * c) / std::sqrt(den));
+                maxCorr = std::max(maxCorr, r);
+                sumCorr += r;
+                ++defined;
+            }
+        }
+        res.bicMax[in] = maxCorr;
+        res.bicMean[in] = defined ? sumCorr / (double)defined : 0;
+    });
+    for (uint64_t u : undefined) res.bicUndefined += u;
+    return res;
+}
+
+// Matrice SAC : une ligne par bit d'entrée, une colonne par bit de sortie
+// (probabilité de changement)
+inline bool sac_write_matrix_csv(const SacResult& r, const std::string& path) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "input_bit";
+    for (size_t j = 0; j < SAC_OUT_BITS; ++j) out << ",out" << j;
+    out << "\n";
+    char buf[32];
+    for (size_t i = 0; i < r.inBits; ++i) {
+        out << i;
+        for (size_t j = 0; j < SAC_OUT_BITS; ++j) {
+            std::snprintf(buf, sizeof(buf), ",%.6f", r.probability(i, j));
+            out << buf;
+        }
+        out << "\n";
+    }
+    return (bool)out;
+}
+
+// Une ligne par bit d'entrée : SAC moyen et pire écart, BIC max et moyen
+inline bool sac_write_summary_csv(const SacResult& r, const std::string& path) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "input_bit,mean_flip_probability,max_bias,bic_max_abs_corr,bic_mean_abs_corr\n";
+    for (size_t i = 0; i < r.inBits; ++i) {
+        double s = 0, bias = 0;
+        for (size_t j = 0; j < SAC_OUT_BITS; ++j) {
+            double p = r.probability(i, j);
+            s += p;
+            bias = std::max(bias, std::fabs(p - 0.5));
+        }
+        out << i << "," << s / SAC_OUT_BITS << "," << bias << ","
+            << r.bicMax[i] << "," << r.bicMean[i] << "\n";
+    }
+    return (bool)out;
+}
@@ -0,0 +1,410 @@
+// sha256.h
+// SHA-256 (FIPS 180-4) pour SHA256_MODE, sans dépendance externe.
+//
+// Trois implémentations de la fonction de compression, choisie à l'exécution :
+//   - portable   : C++ pur, toutes plateformes ;
+//   - SHA-NI     : instructions sha256rnds2/msg1/msg2 (x86 récents) ;
+//   - AVX2 x8    : 8 messages de même longueur en parallèle, un par voie
+//                  32 bits d'un registre ymm (minage : 8 nonces à la fois).
+// Les résultats sont identiques bit à bit dans tous les cas.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "cpu_features.h"
+#include "digest.h"
+#include "miner.h"
+
+#if AC_ENGINE_X86
+#include <immintrin.h>
+#endif
+
+const size_t SHA256_DIGEST_BYTES = 32;
+const size_t SHA256_BLOCK_BYTES = 64;
+const int SHA256_LANES = 8;
+
+inline constexpr uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+inline constexpr uint32_t SHA256_H0[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+inline uint32_t load_be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+inline void store_be32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24); p[1] = (uint8_t)(v >> 16); p[2] = (uint8_t)(v >> 8); p[3] = (uint8_t)v;
+}
+
+// Compression de nblocks blocs de 64 octets consécutifs
+typedef void (*Sha256Compress)(uint32_t state[8], const uint8_t* blocks, size_t nblocks);
+
+// ===========================================================
+// ================ VERSION PORTABLE =========================
+// ===========================================================
+
+inline uint32_t rotr32(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+inline void sha256_compress_portable(uint32_t state[8], const uint8_t* blocks, size_t nblocks) {
+    for (; nblocks > 0; --nblocks, blocks += SHA256_BLOCK_BYTES) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) w[i] = load_be32(blocks + 4 * i);
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = rotr32(w[i-15], 7) ^ rotr32(w[i-15], 18) ^ (w[i-15] >> 3);
+            uint32_t s1 = rotr32(w[i-2], 17) ^ rotr32(w[i-2], 19) ^ (w[i-2] >> 10);
+            w[i] = w[i-16] + s0 + w[i-7] + s1;
+        }
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t t1 = h + (rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25))
+                        + ((e & f) ^ (~e & g)) + SHA256_K[i] + w[i];
+            uint32_t t2 = (rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22))
+                        + ((a & b) ^ (a & c) ^ (b & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+}
+
+#if AC_ENGINE_X86
+
+// ===========================================================
+// ================ VERSION SHA-NI ===========================
+// ===========================================================
+
+// L'état est réorganisé en ABEF / CDGH, l'ordre attendu par sha256rnds2 ;
+// chaque groupe de 4 tours consomme 4 mots du message, et le message étendu
+// est produit 4 mots à la fois par sha256msg1/msg2.
+__attribute__((target("sha,sse4.1")))
+inline void sha256_compress_shani(uint32_t state[8], const uint8_t* blocks, size_t nblocks) {
+    const __m128i BSWAP = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_loadu_si128((const __m128i*)&state[0]);
+    __m128i s1 = _mm_loadu_si128((const __m128i*)&state[4]);
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);        // CDAB
+    s1 = _mm_shuffle_epi32(s1, 0x1B);          // EFGH
+    __m128i s0 = _mm_alignr_epi8(tmp, s1, 8);  // ABEF
+    s1 = _mm_blend_epi16(s1, tmp, 0xF0);       // CDGH
+
+    for (; nblocks > 0; --nblocks, blocks += SHA256_BLOCK_BYTES) {
+        __m128i abef = s0, cdgh = s1;
+        __m128i msg[4];
+#pragma GCC unroll 16
+        for (int g = 0; g < 16; ++g) {
+            __m128i& m = msg[g & 3];
+            if (g < 4) {
+                m = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 16 * g)), BSWAP);
+            } else {
+                // W[t..t+3] à partir de W[t-16..t-1]
+                __m128i w7 = _mm_alignr_epi8(msg[(g - 1) & 3], msg[(g - 2) & 3], 4);
+                m = _mm_sha256msg1_epu32(m, msg[(g - 3) & 3]);
+                m = _mm_sha256msg2_epu32(_mm_add_epi32(m, w7), msg[(g - 1) & 3]);
+            }
+            __m128i km = _mm_add_epi32(m, _mm_loadu_si128((const __m128i*)&SHA256_K[4 * g]));
+            s1 = _mm_sha256rnds2_epu32(s1, s0, km);
+            s0 = _mm_sha256rnds2_epu32(s0, s1, _mm_shuffle_epi32(km, 0x0E));
+        }
+        s0 = _mm_add_epi32(s0, abef);
+        s1 = _mm_add_epi32(s1, cdgh);
+    }
+
+    tmp = _mm_shuffle_epi32(s0, 0x1B);         // FEBA
+    s1 = _mm_shuffle_epi32(s1, 0xB1);          // DCHG
+    s0 = _mm_blend_epi16(tmp, s1, 0xF0);       // DCBA
+    s1 = _mm_alignr_epi8(s1, tmp, 8);          // HGFE
+    _mm_storeu_si128((__m128i*)&state[0], s0);
+    _mm_storeu_si128((__m128i*)&state[4], s1);
+}
+
+// ===========================================================
+// ================ VERSION AVX2 8 VOIES =====================
+// ===========================================================
+
+// Compression d'un bloc pour 8 messages : voie L du registre = message L.
+// blocks[L] pointe sur le bloc de 64 octets du message L.
+__attribute__((target("avx2")))
+inline void sha256_compress_x8_avx2(uint32_t state[8][SHA256_LANES],
+                                    const uint8_t* const blocks[SHA256_LANES]) {
+    typedef uint32_t u32x8 __attribute__((vector_size(32)));
+#define rotr(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+    u32x8 w[64];
+    for (int i = 0; i < 16; ++i)
+        for (int L = 0; L < SHA256_LANES; ++L)
+            w[i][L] = load_be32(blocks[L] + 4 * i);
+    for (int i = 16; i < 64; ++i) {
+        u32x8 s0 = rotr(w[i-15], 7) ^ rotr(w[i-15], 18) ^ (w[i-15] >> 3);
+        u32x8 s1 = rotr(w[i-2], 17) ^ rotr(w[i-2], 19) ^ (w[i-2] >> 10);
+        w[i] = w[i-16] + s0 + w[i-7] + s1;
+    }
+
+    u32x8 v[8];
+    std::memcpy(v, state, sizeof(v));
+    u32x8 a = v[0], b = v[1], c = v[2], d = v[3], e = v[4], f = v[5], g = v[6], h = v[7];
+    for (int i = 0; i < 64; ++i) {
+        u32x8 t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25))
+                 + ((e & f) ^ (~e & g)) + SHA256_K[i] + w[i];
+        u32x8 t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    v[0] += a; v[1] += b; v[2] += c; v[3] += d;
+    v[4] += e; v[5] += f; v[6] += g; v[7] += h;
+    std::memcpy(state, v, sizeof(v));
+#undef rotr
+}
+
+#endif // AC_ENGINE_X86
+
+// ===========================================================
+// ================ DISPATCH À L'EXÉCUTION ===================
+// ===========================================================
+
+enum Sha256Impl { SHA256_PORTABLE, SHA256_SHANI, SHA256_AVX2_X8 };
+
+inline bool cpu_supports_sha256(Sha256Impl impl) {
+#if AC_ENGINE_X86
+    if (impl == SHA256_SHANI) return __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1");
+    if (impl == SHA256_AVX2_X8) return __builtin_cpu_supports("avx2");
+    return true;
+#else
+    return impl == SHA256_PORTABLE;
+#endif
+}
+
+// Meilleure compression mono-message disponible
+inline Sha256Compress sha256_compress() {
+#if AC_ENGINE_X86
+    static const Sha256Compress fn = cpu_supports_sha256(SHA256_SHANI) ? sha256_compress_shani
+                                                                      : sha256_compress_portable;
+    return fn;
+#else
+    return sha256_compress_portable;
+#endif
+}
+
+// Implémentation utilisée pour hacher 8 messages : SHA-NI reste plus rapide
+// message par message que l'AVX2 à 8 voies, qui sert sur les CPU sans SHA-NI.
+inline Sha256Impl sha256_batch_impl() {
+    static const Sha256Impl impl = cpu_supports_sha256(SHA256_SHANI)   ? SHA256_SHANI
+                                 : cpu_supports_sha256(SHA256_AVX2_X8) ? SHA256_AVX2_X8
+                                                                       : SHA256_PORTABLE;
+    return impl;
+}
+
+inline const char* sha256_impl_name(Sha256Impl impl) {
+    switch (impl) {
+        case SHA256_SHANI:   return "sha-ni";
+        case SHA256_AVX2_X8: return "avx2x8";
+        default:             return "portable";
+    }
+}
+
+// ===========================================================
+// ================ INTERFACE ================================
+// ===========================================================
+
+// Hachage incrémental : update() autant de fois que nécessaire, puis finalize()
+class Sha256 {
+public:
+    explicit Sha256(Sha256Compress compress = sha256_compress()) : compress_(compress) {
+        std::memcpy(state_, SHA256_H0, sizeof(state_));
+    }
+
+    // Reprise depuis un midstate : `absorbed` octets (multiple de 64) déjà
+    // compressés dans `state`
+    Sha256(const uint32_t state[8], uint64_t absorbed, Sha256Compress compress = sha256_compress())
+        : compress_(compress), total_(absorbed) {
+        std::memcpy(state_, state, sizeof(state_));
+    }
+
+    // État après les blocs complets déjà compressés (midstate)
+    const uint32_t* state() const { return state_; }
+
+    void update(const void* data, size_t len) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        total_ += len;
+        if (fill_ > 0) {
+            size_t take = std::min(len, SHA256_BLOCK_BYTES - fill_);
+            std::memcpy(buf_ + fill_, p, take);
+            fill_ += take; p += take; len -= take;
+            if (fill_ < SHA256_BLOCK_BYTES) return;
+            compress_(state_, buf_, 1);
+            fill_ = 0;
+        }
+        size_t full = len / SHA256_BLOCK_BYTES;
+        if (full > 0) compress_(state_, p, full);
+        p += full * SHA256_BLOCK_BYTES;
+        len -= full * SHA256_BLOCK_BYTES;
+        std::memcpy(buf_, p, len);
+        fill_ = len;
+    }
+
+    void finalize(uint8_t out[SHA256_DIGEST_BYTES]) {
+        uint8_t tail[2 * SHA256_BLOCK_BYTES];
+        size_t tlen = sha256_padding(buf_, fill_, total_, tail);
+        compress_(state_, tail, tlen / SHA256_BLOCK_BYTES);
+        for (int i = 0; i < 8; ++i) store_be32(out + 4 * i, state_[i]);
+    }
+
+    // Derniers octets (len < 64) + bourrage + longueur en bits : 1 ou 2 blocs
+    static size_t sha256_padding(const uint8_t* rest, size_t len, uint64_t total,
+                                 uint8_t tail[2 * SHA256_BLOCK_BYTES]) {
+        size_t tlen = len + 9 <= SHA256_BLOCK_BYTES ? SHA256_BLOCK_BYTES : 2 * SHA256_BLOCK_BYTES;
+        std::memset(tail, 0, tlen);
+        std::memcpy(tail, rest, len);
+        tail[len] = 0x80;
+        uint64_t bits = total * 8;
+        for (int k = 0; k < 8; ++k) tail[tlen - 1 - k] = (uint8_t)(bits >> (8 * k));
+        return tlen;
+    }
+
+private:
+    Sha256Compress compress_;
+    uint32_t state_[8];
+    uint8_t buf_[SHA256_BLOCK_BYTES];
+    size_t fill_ = 0;
+    uint64_t total_ = 0;
+};
+
+inline void sha256(const void* data, size_t len, uint8_t out[SHA256_DIGEST_BYTES]) {
+    Sha256 ctx;
+    ctx.update(data, len);
+    ctx.finalize(out);
+}
+
+inline Digest sha256_digest(const void* data, size_t len) {
+    Digest d;
+    sha256(data, len, d.data());
+    return d;
+}
+
+// Empreinte en 64 chiffres hexadécimaux minuscules
+inline std::string sha256_hex(const void* data, size_t len) {
+    return digest_hex(sha256_digest(data, len));
+}
+
+inline std::string sha256_hex(const std::string& data) {
+    return sha256_hex(data.data(), data.size());
+}
+
+// Suite de 8 messages de même longueur len, après un midstate commun `init`
+// ayant absorbé `absorbed` octets (multiple de 64)
+inline void sha256_x8_from(const uint32_t init[8], uint64_t absorbed,
+                           const uint8_t* const msgs[SHA256_LANES], size_t len,
+                           Digest out[SHA256_LANES],
+                           Sha256Impl impl = sha256_batch_impl()) {
+#if AC_ENGINE_X86
+    if (impl == SHA256_AVX2_X8) {
+        uint32_t state[8][SHA256_LANES];
+        for (int i = 0; i < 8; ++i)
+            for (int L = 0; L < SHA256_LANES; ++L) state[i][L] = init[i];
+
+        size_t full = len / SHA256_BLOCK_BYTES;
+        const uint8_t* blocks[SHA256_LANES];
+        for (size_t b = 0; b < full; ++b) {
+            for (int L = 0; L < SHA256_LANES; ++L) blocks[L] = msgs[L] + b * SHA256_BLOCK_BYTES;
+            sha256_compress_x8_avx2(state, blocks);
+        }
+        uint8_t tail[SHA256_LANES][2 * SHA256_BLOCK_BYTES];
+        size_t tlen = 0;
+        for (int L = 0; L < SHA256_LANES; ++L)
+            tlen = Sha256::sha256_padding(msgs[L] + full * SHA256_BLOCK_BYTES,
+                                          len - full * SHA256_BLOCK_BYTES, absorbed + len, tail[L]);
+        for (size_t off = 0; off < tlen; off += SHA256_BLOCK_BYTES) {
+            for (int L = 0; L < SHA256_LANES; ++L) blocks[L] = tail[L] + off;
+            sha256_compress_x8_avx2(state, blocks);
+        }
+        for (int L = 0; L < SHA256_LANES; ++L)
+            for (int i = 0; i < 8; ++i) store_be32(out[L].data() + 4 * i, state[i][L]);
+        return;
+    }
+    Sha256Compress compress = impl == SHA256_SHANI ? sha256_compress_shani : sha256_compress_portable;
+#else
+    (void)impl;
+    Sha256Compress compress = sha256_compress_portable;
+#endif
+    for (int L = 0; L < SHA256_LANES; ++L) {
+        Sha256 ctx(init, absorbed, compress);
+        ctx.update(msgs[L], len);
+        ctx.finalize(out[L].data());
+    }
+}
+
+// 8 messages de même longueur len
+inline void sha256_x8(const uint8_t* const msgs[SHA256_LANES], size_t len,
+                      Digest out[SHA256_LANES],
+                      Sha256Impl impl = sha256_batch_impl()) {
+    sha256_x8_from(SHA256_H0, 0, msgs, len, out, impl);
+}
+
+// ===========================================================
+// ================ MINAGE ===================================
+// ===========================================================
+
+// Hash de prefix + nonce encodé, pour des nonces consécutifs. Les blocs
+// complets du préfixe sont compressés une seule fois (midstate) : chaque
+// essai ne compresse que la fin du préfixe, le nonce et le bourrage, soit
+// 1 ou 2 blocs quelle que soit la taille de data. Les nonces sont hachés par
+// lots de 8 de même longueur (sha256_x8_from), mis en cache.
+class Sha256NonceHasher {
+public:
+    Sha256NonceHasher(const std::string& prefix, NonceEncoder encode = decimal_nonce)
+        : encode_(encode) {
+        size_t full = prefix.size() / SHA256_BLOCK_BYTES * SHA256_BLOCK_BYTES;
+        Sha256 ctx;
+        ctx.update(prefix.data(), full);
+        std::memcpy(mid_, ctx.state(), sizeof(mid_));
+        absorbed_ = full;
+        rest_ = prefix.size() - full;
+        for (int L = 0; L < SHA256_LANES; ++L) {
+            msg_[L].assign(prefix.begin() + full, prefix.end());
+            msg_[L].resize(rest_ + NONCE_MAX_BYTES);
+        }
+    }
+
+    const Digest& hash(int64_t nonce) {
+        if (nonce < batchFirst_ || nonce >= batchFirst_ + batchCount_) hash_batch(nonce);
+        return digest_[nonce - batchFirst_];
+    }
+
+private:
+    // lot de nonces consécutifs dont l'encodage a la même longueur ; les
+    // voies inutilisées recopient la première
+    void hash_batch(int64_t first) {
+        size_t len = encode_(first, msg_[0].data() + rest_);
+        int count = 1;
+        for (; count < SHA256_LANES; ++count)
+            if (encode_(first + count, msg_[count].data() + rest_) != len) break;
+        const uint8_t* msgs[SHA256_LANES];
+        for (int L = 0; L < SHA256_LANES; ++L)
+            msgs[L] = reinterpret_cast<const uint8_t*>(msg_[L < count ? L : 0].data());
+        sha256_x8_from(mid_, absorbed_, msgs, rest_ + len, digest_);
+        batchFirst_ = first;
+        batchCount_ = count;
+    }
+
+    uint32_t mid_[8];    // état après les blocs complets du préfixe
+    uint64_t absorbed_;  // octets du préfixe déjà compressés
+    size_t rest_;        // octets du préfixe après le dernier bloc complet
+    NonceEncoder encode_;
+    std::vector<char> msg_[SHA256_LANES];
+    Digest digest_[SHA256_LANES];
+    int64_t batchFirst_ = 0;
+    int batchCount_ = 0;
+};
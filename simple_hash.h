@@ -0,0 +1,90 @@
+// simple_hash.h
+// Le hash polynomial des exercices (SIMPLE_HASH_MODE) :
+//     hash = (hash * 101 + c) % 1000000007
+// calculé de gauche à droite en arithmétique unsigned int (le produit
+// déborde modulo 2^32 avant le %, comme dans la version d'origine).
+//
+// Le hash ne dépend que de l'état courant et des octets restants : pour le
+// minage, l'état après le préfixe fixe index||previousHash||timestamp||data
+// (le "midstate") est calculé une fois, et chaque essai ne fait rouler que
+// les chiffres du nonce. Le coût par nonce ne dépend plus de la taille de data.
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include "digest.h"
+#include "miner.h"
+
+const uint32_t SIMPLE_HASH_MOD = 1000000007;
+const int SIMPLE_HASH_LANES = 8;
+
+inline uint32_t simple_hash_update(uint32_t hash, const char* data, size_t len) {
+    for (size_t i = 0; i < len; ++i)
+        hash = (hash * 101 + (uint32_t)(int)data[i]) % SIMPLE_HASH_MOD;
+    return hash;
+}
+
+// Les 32 bits du hash dans les 4 premiers octets du digest (gros-boutiste)
+inline Digest simple_hash_digest(uint32_t hash) {
+    Digest d{};
+    for (int k = 0; k < 4; ++k) d[k] = (uint8_t)(hash >> (24 - 8 * k));
+    return d;
+}
+
+// 8 chiffres hexadécimaux minuscules, comme `ss << hex << setw(8) << setfill('0')`
+inline std::string simple_hash_hex(uint32_t hash) {
+    return digest_hex(simple_hash_digest(hash), 8);
+}
+
+// Hash de prefix + nonce encodé à partir du midstate du préfixe. Les nonces
+// consécutifs de même longueur sont roulés 8 à la fois : les premiers
+// chiffres, communs aux 8 nonces, une seule fois, puis les derniers avec une
+// voie d'un vecteur 32 bits par nonce ; le modulo se fait par soustractions
+// conditionnelles (hash * 101 + c < 2^32 vaut au plus 4 fois le module).
+class SimpleHashNonceHasher {
+public:
+    SimpleHashNonceHasher(const std::string& prefix, NonceEncoder encode = decimal_nonce)
+        : mid_(simple_hash_update(0, prefix.data(), prefix.size())), encode_(encode) {}
+
+    uint32_t value(int64_t nonce) {
+        if (nonce < batchFirst_ || nonce >= batchFirst_ + batchCount_) hash_batch(nonce);
+        return hash_[nonce - batchFirst_];
+    }
+
+    Digest hash(int64_t nonce) { return simple_hash_digest(value(nonce)); }
+
+private:
+    void hash_batch(int64_t first) {
+        typedef uint32_t u32x8 __attribute__((vector_size(32)));
+        char bytes[SIMPLE_HASH_LANES][NONCE_MAX_BYTES];
+        size_t len = encode_(first, bytes[0]);
+        int count = 1;
+        for (; count < SIMPLE_HASH_LANES; ++count)
+            if (encode_(first + count, bytes[count]) != len) break;
+
+        size_t common = len;
+        for (int L = 1; L < count; ++L)
+            while (common > 0 && std::memcmp(bytes[0], bytes[L], common) != 0) --common;
+
+        u32x8 h = u32x8{} + simple_hash_update(mid_, bytes[0], common);
+        for (size_t k = common; k < len; ++k) {
+            u32x8 c;
+            for (int L = 0; L < SIMPLE_HASH_LANES; ++L)
+                c[L] = (uint32_t)(int)bytes[L < count ? L : 0][k];
+            h = h * 101 + c;
+            for (int r = 0; r < 4; ++r)
+                h -= (u32x8)(h >= SIMPLE_HASH_MOD) & SIMPLE_HASH_MOD;
+        }
+        for (int L = 0; L < SIMPLE_HASH_LANES; ++L) hash_[L] = h[L];
+        batchFirst_ = first;
+        batchCount_ = count;
+    }
+
+    uint32_t mid_;
+    NonceEncoder encode_;
+    uint32_t hash_[SIMPLE_HASH_LANES];
+    int64_t batchFirst_ = 0;
+    int batchCount_ = 0;
+};
@@ -0,0 +1,349 @@
+// stat_tests.h
+// Batterie de tests statistiques en flux sur une suite de bits (sortie d'un
+// hash), d'après NIST SP 800-22 : fréquence (monobit), fréquence par blocs,
+// runs, serial, entropie approchée et complexité linéaire, avec p-valeurs.
+//
+// La suite est produite par segments de STAT_SEGMENT_BITS bits (fill(i, w)
+// écrit le segment i, bit de poids fort en premier) ; les threads prennent
+// les segments un par un et cumulent des compteurs locaux, fusionnés à la
+// fin : la mémoire ne dépend pas de la longueur de la suite (à 16 octets par
+// segment près, pour les bords). Par segment :
+//   - nombre de 1 et de transitions 0/1 entre bits voisins ;
+//   - fréquence des blocs de STAT_BLOCK_FREQ_BITS bits ;
+//   - occurrences des motifs de STAT_PATTERN_BITS bits (chevauchants) ; les
+//     motifs plus courts des tests serial et ApEn s'en déduisent, la suite
+//     étant lue comme circulaire ;
+//   - complexité linéaire (Berlekamp-Massey) d'un bloc de
+//     STAT_LC_BLOCK_BITS bits tous les STAT_LC_STRIDE_BITS bits : c'est le
+//     test le plus coûteux (~30 Mbit/s par cœur sur tous les blocs), et un
+//     gigaoctet en donne encore un million de blocs (NIST en demande 200).
+// Les motifs et transitions qui chevauchent deux segments sont comptés à la
+// fusion, à partir des premiers et derniers bits de chaque segment. Le
+// résultat ne dépend donc pas du nombre de threads.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "miner.h"
+
+const size_t STAT_SEGMENT_BITS = 1 << 20;
+const size_t STAT_SEGMENT_WORDS = STAT_SEGMENT_BITS / 64;
+const size_t STAT_BLOCK_FREQ_BITS = 8192;
+const size_t STAT_PATTERN_BITS = 16;
+const size_t STAT_LC_BLOCK_BITS = 512;
+const size_t STAT_LC_STRIDE_BITS = 8192;
+const size_t STAT_LC_CLASSES = 7;
+const double STAT_ALPHA = 0.01; // seuil de réussite d'un test (p >= alpha)
+
+// ===========================================================
+// ================ FONCTIONS SPÉCIALES ======================
+// ===========================================================
+
+// Fonction gamma incomplète régularisée P(a, x) (série) et Q(a, x) = 1 - P
+// (fraction continue de Lentz), comme igam / igamc de Cephes
+inline double stat_igam(double a, double x);
+
+inline double stat_igamc(double a, double x) {
+    if (x <= 0 || a <= 0) return 1.0;
+    if (x < a + 1) return 1.0 - stat_igam(a, x);
+    const double TINY = 1e-300;
+    double b = x + 1 - a, c = 1 / TINY, d = 1 / b, h = d;
+    for (int i = 1; i < 100000; ++i) {
+        double an = -i * (i - a);
+        b += 2;
+        d = an * d + b;
+        if (std::fabs(d) < TINY) d = TINY;
+        c = b + an / c;
+        if (std::fabs(c) < TINY) c = TINY;
+        d = 1 / d;
+        double del = d * c;
+        h *= del;
+        if (std::fabs(del - 1) < 1e-15) break;
+    }
+    return std::exp(-x + a * std::log(x) - std::lgamma(a)) * h;
+}
+
+inline double stat_igam(double a, double x) {
+    if (x <= 0 || a <= 0) return 0.0;
+    if (x >= a + 1) return 1.0 - stat_igamc(a, x);
+    double ap = a, sum = 1 / a, del = sum;
+    for (int i = 0; i < 1000000; ++i) {
+        ap += 1;
+        del *= x / ap;
+        sum += del;
+        if (std::fabs(del) < std::fabs(sum) * 1e-15) break;
+    }
+    return sum * std::exp(-x + a * std::log(x) - std::lgamma(a));
+}
+
+// ===========================================================
+// ================ COMPLEXITÉ LINÉAIRE ======================
+// ===========================================================
+
+// Berlekamp-Massey sur STAT_LC_BLOCK_BITS bits (w : bit de poids fort
+// d'abord). C et B sont des polynômes sur GF(2) (bit i = coefficient de
+// x^i) ; R contient la suite retournée (bit i = s[n - i]), de sorte que la
+// discordance est la parité de C & R.
+inline int linear_complexity_block(const uint64_t* w) {
+    const size_t M = STAT_LC_BLOCK_BITS, NW = M / 64 + 1;
+    uint64_t C[NW] = {1}, B[NW] = {1}, R[NW] = {}, T[NW];
+    size_t L = 0;
+    long m = -1;
+    for (size_t n = 0; n < M; ++n) {
+        size_t used = n / 64 + 1; // mots significatifs de R (bits 0..n)
+        for (size_t k = used; k-- > 1;) R[k] = (R[k] << 1) | (R[k - 1] >> 63);
+        R[0] = (R[0] << 1) | ((w[n / 64] >> (63 - n % 64)) & 1);
+
+        uint64_t acc = 0;
+        for (size_t k = 0; k <= L / 64; ++k) acc ^= C[k] & R[k];
+        if (!__builtin_parityll(acc)) continue;
+
+        // C ^= B << (n - m)
+        size_t shift = (size_t)((long)n - m), ws = shift / 64, bs = shift % 64;
+        std::memcpy(T, C, sizeof(C));
+        for (size_t k = NW; k-- > ws;) {
+            uint64_t v = B[k - ws] << bs;
+            if (bs && k > ws) v |= B[k - ws - 1] >> (64 - bs);
+            C[k] ^= v;
+        }
+        if (2 * L <= n) {
+            L = n + 1 - L;
+            m = (long)n;
+            std::memcpy(B, T, sizeof(B));
+        }
+    }
+    return (int)L;
+}
+
+// Classe de T = (-1)^M (L - mu) + 2/9 (NIST 2.10.4) : bornes -2.5 ... 2.5
+inline size_t linear_complexity_class(int L) {
+    const double M = (double)STAT_LC_BLOCK_BITS;
+    const double sign = (STAT_LC_BLOCK_BITS % 2) ? -1.0 : 1.0;
+    static const double mu = M / 2 + (9 - sign) / 36 - (M / 3 + 2.0 / 9) / std::pow(2.0, M);
+    double t = sign * (L - mu) + 2.0 / 9;
+    size_t k = 0;
+    while (k < STAT_LC_CLASSES - 1 && t > -2.5 + (double)k) ++k;
+    return k;
+}
+
+// ===========================================================
+// ================ ACCUMULATION ==============================
+// ===========================================================
+
+struct StatCounters {
+    uint64_t bits = 0, ones = 0, transitions = 0;
+    double blockFreqChi = 0; // somme des (pi_i - 1/2)^2
+    uint64_t blockFreqBlocks = 0;
+    std::vector<uint64_t> patterns = std::vector<uint64_t>(size_t(1) << STAT_PATTERN_BITS, 0);
+    uint64_t lcClasses[STAT_LC_CLASSES] = {};
+
+    void merge(const StatCounters& o) {
+        bits += o.bits;
+        ones += o.ones;
+        transitions += o.transitions;
+        blockFreqChi += o.blockFreqChi;
+        blockFreqBlocks += o.blockFreqBlocks;
+        for (size_t i = 0; i < patterns.size(); ++i) patterns[i] += o.patterns[i];
+        for (size_t i = 0; i < STAT_LC_CLASSES; ++i) lcClasses[i] += o.lcClasses[i];
+    }
+};
+
+// Premier et dernier mot d'un segment, pour les motifs et transitions à
+// cheval sur deux segments
+struct StatSegmentEdge {
+    uint64_t first, last;
+};
+
+// Motifs de STAT_PATTERN_BITS bits commençant aux bits [0, nbits - P] de w
+inline void count_patterns(const uint64_t* w, size_t nwords, uint64_t* counts) {
+    const size_t P = STAT_PATTERN_BITS;
+    const uint64_t mask = (1ULL << P) - 1;
+    uint64_t window = w[0] >> (64 - (P - 1)); // P - 1 premiers bits
+    for (size_t i = 0; i < nwords; ++i) {
+        uint64_t x = w[i];
+        size_t from = (i == 0) ? P - 1 : 0;
+        for (size_t b = from; b < 64; ++b) {
+            window = ((window << 1) | ((x >> (63 - b)) & 1)) & mask;
+            ++counts[window];
+        }
+    }
+}
+
+inline void stat_segment(const uint64_t* w, StatCounters& c) {
+    const size_t NW = STAT_SEGMENT_WORDS;
+    c.bits += STAT_SEGMENT_BITS;
+
+    for (size_t b = 0; b < NW; b += STAT_BLOCK_FREQ_BITS / 64) {
+        uint64_t ones = 0;
+        for (size_t i = b; i < b + STAT_BLOCK_FREQ_BITS / 64; ++i)
+            ones += (uint64_t)__builtin_popcountll(w[i]);
+        c.ones += ones;
+        double pi = (double)ones / STAT_BLOCK_FREQ_BITS - 0.5;
+        c.blockFreqChi += pi * pi;
+        ++c.blockFreqBlocks;
+    }
+
+    // transitions : bit k comparé au bit k + 1 (le suivant du dernier bit
+    // d'un mot est le premier bit du mot suivant)
+    for (size_t i = 0; i + 1 < NW; ++i)
+        c.transitions += (uint64_t)__builtin_popcountll(w[i] ^ ((w[i] << 1) | (w[i + 1] >> 63)));
+    c.transitions += (uint64_t)__builtin_popcountll((w[NW - 1] ^ (w[NW - 1] << 1)) & ~1ULL);
+
+    count_patterns(w, NW, c.patterns.data());
+
+    for (size_t b = 0; b < NW; b += STAT_LC_STRIDE_BITS / 64)
+        ++c.lcClasses[linear_complexity_class(linear_complexity_block(w + b))];
+}
+
+// ===========================================================
+// ================ P-VALEURS =================================
+// ===========================================================
+
+struct StatTestResult {
+    std::string name;
+    double p;
+    bool passed() const { return p >= STAT_ALPHA; }
+};
+
+struct StatReport {
+    uint64_t bits = 0;
+    std::vector<StatTestResult> tests;
+};
+
+// Nombre d'occurrences de chaque motif de m bits (m <= STAT_PATTERN_BITS),
+// déduit des motifs longs : suite circulaire, chaque position commence
+// exactement un motif de chaque longueur
+inline std::vector<uint64_t> pattern_counts(const std::vector<uint64_t>& full, size_t m) {
+    std::vector<uint64_t> out(size_t(1) << m, 0);
+    if (m == 0) {
+        for (uint64_t v : full) out[0] += v;
+        return out;
+    }
+    size_t shift = STAT_PATTERN_BITS - m;
+    for (size_t v = 0; v < full.size(); ++v) out[v >> shift] += full[v];
+    return out;
+}
+
+// psi^2_m du test serial : (2^m / n) somme (v_i - n / 2^m)^2, forme stable
+inline double serial_psi2(const std::vector<uint64_t>& full, size_t m, double n) {
+    if (m == 0) return 0;
+    std::vector<uint64_t> v = pattern_counts(full, m);
+    long double expected = (long double)n / v.size(), s = 0;
+    for (uint64_t x : v) s += ((long double)x - expected) * ((long double)x - expected);
+    return (double)(s / expected);
+}
+
+// phi_m du test ApEn : somme de pi ln pi sur les motifs de m bits
+inline long double apen_phi(const std::vector<uint64_t>& full, size_t m, double n) {
+    long double s = 0;
+    for (uint64_t x : pattern_counts(full, m))
+        if (x) s += (long double)x / n * std::log((long double)x / n);
+    return s;
+}
+
+inline StatReport stat_report(const StatCounters& c) {
+    StatReport r;
+    r.bits = c.bits;
+    const double n = (double)c.bits;
+
+    // Fréquence (monobit)
+    double s = 2.0 * (double)c.ones - n;
+    r.tests.push_back({"Frequence (monobit)", std::erfc(std::fabs(s) / std::sqrt(2 * n))});
+
+    // Fréquence par blocs : chi2 = 4 M somme (pi_i - 1/2)^2, N degrés
+    double chi = 4.0 * STAT_BLOCK_FREQ_BITS * c.blockFreqChi;
+    r.tests.push_back({"Frequence par blocs (M=" + std::to_string(STAT_BLOCK_FREQ_BITS) + ")",
+                       stat_igamc(c.blockFreqBlocks / 2.0, chi / 2)});
+
+    // Runs : nombre de suites de bits identiques = transitions + 1
+    double pi = (double)c.ones / n, runsP = 0;
+    if (std::fabs(pi - 0.5) < 2 / std::sqrt(n)) {
+        double v = (double)c.transitions + 1;
+        runsP = std::erfc(std::fabs(v - 2 * n * pi * (1 - pi)) /
+                          (2 * std::sqrt(2 * n) * pi * (1 - pi)));
+    }
+    r.tests.push_back({"Runs", runsP});
+
+    // Serial et ApEn : m < log2(n) - 2 (resp. - 5), borné par les motifs comptés
+    size_t log2n = (size_t)std::floor(std::log2(n));
+    size_t ms = std::min<size_t>(STAT_PATTERN_BITS, log2n > 5 ? log2n - 3 : 2);
+    size_t ma = std::min<size_t>(STAT_PATTERN_BITS - 1, log2n > 8 ? log2n - 6 : 2);
+    double p0 = serial_psi2(c.patterns, ms, n), p1 = serial_psi2(c.patterns, ms - 1, n),
+           p2 = serial_psi2(c.patterns, ms - 2, n);
+    r.tests.push_back({"Serial 1 (m=" + std::to_string(ms) + ")",
+                       stat_igamc(std::ldexp(1.0, (int)ms - 2), (p0 - p1) / 2)});
+    r.tests.push_back({"Serial 2 (m=" + std::to_string(ms) + ")",
+                       stat_igamc(std::ldexp(1.0, (int)ms - 3), (p0 - 2 * p1 + p2) / 2)});
+
+    long double apen = apen_phi(c.patterns, ma, n) - apen_phi(c.patterns, ma + 1, n);
+    double apenChi = (double)(2 * (long double)n * (std::log((long double)2) - apen));
+    r.tests.push_back({"Entropie approchee (m=" + std::to_string(ma) + ")",
+                       stat_igamc(std::ldexp(1.0, (int)ma - 1), apenChi / 2)});
+
+    // Complexité linéaire : chi2 à 6 degrés sur les 7 classes
+    static const double LC_PI[STAT_LC_CLASSES] = {0.010417, 0.03125, 0.125, 0.5,
+                                                  0.25, 0.0625, 0.020833};
+    double blocks = 0, lcChi = 0;
+    for (uint64_t v : c.lcClasses) blocks += (double)v;
+    for (size_t i = 0; i < STAT_LC_CLASSES; ++i) {
+        double e = blocks * LC_PI[i];
+        lcChi += (c.lcClasses[i] - e) * (c.lcClasses[i] - e) / e;
+    }
+    r.tests.push_back({"Complexite lineaire (M=" + std::to_string(STAT_LC_BLOCK_BITS) + ")",
+                       stat_igamc(3, lcChi / 2)});
+    return r;
+}
+
+// ===========================================================
+// ================ BATTERIE ==================================
+// ===========================================================
+
+// fill(i, w) écrit les STAT_SEGMENT_WORDS mots du segment i ; il est appelé
+// en parallèle (threads = 0 : un par cœur)
+template <class Fill>
+StatReport stat_battery(size_t segments, Fill fill, unsigned threads = 0) {
+    if (segments == 0) segments = 1;
+    if (threads == 0) threads = default_mining_threads();
+    if (threads > segments) threads = (unsigned)segments;
+
+    std::vector<StatCounters> local(threads);
+    std::vector<StatSegmentEdge> edges(segments);
+    std::atomic<size_t> next(0);
+    auto run = [&](unsigned t) {
+        std::vector<uint64_t> w(STAT_SEGMENT_WORDS);
+        for (size_t i; (i = next.fetch_add(1)) < segments;) {
+            fill(i, w.data());
+            stat_segment(w.data(), local[t]);
+            edges[i] = {w[0], w[STAT_SEGMENT_WORDS - 1]};
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(run, t);
+    run(0);
+    for (std::thread& th : pool) th.join();
+
+    StatCounters total = std::move(local[0]);
+    for (unsigned t = 1; t < threads; ++t) total.merge(local[t]);
+
+    // bords : transitions entre segments consécutifs (pas de retour au
+    // début), motifs à cheval sur deux segments, y compris du dernier au
+    // premier (suite circulaire)
+    const size_t P = STAT_PATTERN_BITS;
+    const uint64_t mask = (1ULL << P) - 1;
+    for (size_t i = 0; i < segments; ++i) {
+        uint64_t last = edges[i].last, first = edges[(i + 1) % segments].first;
+        if (i + 1 < segments) total.transitions += (last & 1) != (first >> 63);
+        // P - 1 derniers bits suivis des P - 1 premiers
+        uint64_t window = ((last & ((1ULL << (P - 1)) - 1)) << (P - 1)) | (first >> (64 - (P - 1)));
+        for (size_t k = 0; k < P - 1; ++k)
+            ++total.patterns[(window >> (P - 2 - k)) & mask];
+    }
+    return stat_report(total);
+}
@@ -0,0 +1,97 @@
+// target.h
+// Cible de minage numérique sur 256 bits.
+//
+// Un hash est valide si, lu comme un entier gros-boutiste de 256 bits, il est
+// inférieur ou égal à la cible. L'ancienne difficulté "d chiffres '0' en
+// tête" correspond à la cible 2^(256 - 4d) - 1, mais la cible peut prendre
+// n'importe quelle valeur : le travail attendu n'est plus limité aux
+// multiples de 16 et peut être réajusté finement (retarget_target).
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include "digest.h"
+
+typedef Digest Target;
+
+// hash <= target, mot de 64 bits par mot, arrêt au premier mot différent
+inline bool meets_target(const Digest& hash, const Target& target) {
+    for (size_t i = 0; i < DIGEST_WORDS; ++i) {
+        uint64_t h = hash.word(i), t = target.word(i);
+        if (h != t) return h < t;
+    }
+    return true;
+}
+
+// Cible dont les `bits` premiers bits sont nuls et les suivants à 1
+inline Target target_from_zero_bits(size_t bits) {
+    Target t;
+    for (size_t k = 0; k < DIGEST_BYTES; ++k) {
+        size_t zeros = bits > 8 * k ? bits - 8 * k : 0;
+        t[k] = zeros >= 8 ? 0 : (uint8_t)(0xFF >> zeros);
+    }
+    return t;
+}
+
+// Équivalent numérique de "difficulty chiffres hexadécimaux '0' en tête"
+inline Target target_from_hex_digits(int difficulty) {
+    return target_from_zero_bits(4 * (size_t)std::max(difficulty, 0));
+}
+
+// Bits de tête nuls de la cible : tout hash valide commence par autant de
+// zéros (condition nécessaire utilisée par les sondes AC)
+inline size_t target_zero_bits(const Target& t) {
+    for (size_t i = 0; i < DIGEST_WORDS; ++i) {
+        uint64_t w = t.word(i);
+        if (w) return 64 * i + __builtin_clzll(w);
+    }
+    return 8 * DIGEST_BYTES;
+}
+
+// Nombre moyen de hashes pour passer la cible : 2^256 / (target + 1)
+inline double target_work(const Target& t) {
+    double v = 0;
+    for (size_t i = 0; i < DIGEST_WORDS; ++i)
+        v = v * 18446744073709551616.0 + (double)t.word(i);
+    return std::ldexp(1.0, 256) / (v + 1.0);
+}
+
+// target * num / den (num, den < 2^32), plafonné à 2^256 - 1
+inline Target scale_target(const Target& t, uint64_t num, uint64_t den) {
+    // limbs[0] = mot de poids faible
+    uint64_t limbs[DIGEST_WORDS + 1];
+    unsigned __int128 carry = 0;
+    for (size_t i = 0; i < DIGEST_WORDS; ++i) {
+        carry += (unsigned __int128)t.word(DIGEST_WORDS - 1 - i) * num;
+        limbs[i] = (uint64_t)carry;
+        carry >>= 64;
+    }
+    limbs[DIGEST_WORDS] = (uint64_t)carry;
+
+    unsigned __int128 rem = 0;
+    for (size_t i = DIGEST_WORDS + 1; i-- > 0;) {
+        rem = (rem << 64) | limbs[i];
+        limbs[i] = (uint64_t)(rem / den);
+        rem %= den;
+    }
+
+    Target out;
+    for (size_t i = 0; i < DIGEST_WORDS; ++i) {
+        uint64_t w = limbs[DIGEST_WORDS] ? ~0ULL : limbs[DIGEST_WORDS - 1 - i];
+        for (int k = 0; k < 8; ++k) out[8 * i + k] = (uint8_t)(w >> (56 - 8 * k));
+    }
+    return out;
+}
+
+// Réajustement : la cible est multipliée par temps observé / temps visé sur
+// la fenêtre, rapport borné à [1/4, 4] pour qu'une fenêtre aberrante ne
+// fasse pas varier le travail de plus d'un facteur 4.
+inline Target retarget_target(const Target& t, double actualSeconds, double expectedSeconds) {
+    const double MAX_FACTOR = 4.0;
+    if (expectedSeconds <= 0) return t;
+    double ratio = std::min(std::max(actualSeconds / expectedSeconds, 1.0 / MAX_FACTOR), MAX_FACTOR);
+    const uint64_t SCALE = 1u << 20; // précision du rapport
+    return scale_target(t, (uint64_t)std::llround(ratio * SCALE), SCALE);
+}